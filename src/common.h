@@ -48,7 +48,9 @@ typedef uint64_t u64;
 typedef float    f32;
 typedef double   f64;
 
-#define MPXTN_SPS   44100
+#define MPXTN_SPS   44100 /* default and base sample rate */
+#define MPXTN_SPS_MIN  8000
+#define MPXTN_SPS_MAX 192000
 #define MPXTN_BPS       8
 #define MPXTN_CH        2
 
@@ -73,6 +75,7 @@ typedef double   f64;
 #define WOICEINSTANCE_MAX    2
 
 #define BUFSIZE_TIMEPAN      0x40
+#define BUFSIZE_RENDER      0x100 /* samples per render block */
 
 #define VOICEFLAG_WAVELOOP   0x00000001u
 #define VOICEFLAG_SMOOTH     0x00000002u
@@ -95,6 +98,18 @@ typedef double   f64;
 #define EVENTDEFAULT_BEATTEMPO     120
 #define EVENTDEFAULT_BEATCLOCK     480
 
+/* reference counter */
+#ifdef _MSC_VER
+#include <intrin.h>
+#define ref_inc(p) _InterlockedIncrement((volatile long*)(p))
+#define ref_dec(p) _InterlockedDecrement((volatile long*)(p))
+#define ref_get(p) _InterlockedOr((volatile long*)(p), 0)
+#else
+#define ref_inc(p) __atomic_add_fetch((p), 1, __ATOMIC_ACQ_REL)
+#define ref_dec(p) __atomic_sub_fetch((p), 1, __ATOMIC_ACQ_REL)
+#define ref_get(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#endif
+
 typedef struct {
 	s32 x;
 	s32 y;
@@ -48,7 +48,7 @@ void delay_tone_release(DELAY *p_delay)
 	return;
 }
 
-bool delay_tone_ready(DELAY *p_delay, u32 beat_num, float beat_tempo)
+bool delay_tone_ready(DELAY *p_delay, u32 beat_num, float beat_tempo, u32 sps)
 {
 	delay_tone_release(p_delay);
 
@@ -60,42 +60,63 @@ bool delay_tone_ready(DELAY *p_delay, u32 beat_num, float beat_tempo)
 	switch(p_delay->unit)
 	{
 	case DELAYUNIT_Beat:
-		p_delay->smp_num = MPXTN_SPS * 60 / beat_tempo / p_delay->freq;
+		p_delay->smp_num = sps * 60 / beat_tempo / p_delay->freq;
 		break;
 	case DELAYUNIT_Meas:
-		p_delay->smp_num = MPXTN_SPS * 60 * beat_num / beat_tempo / p_delay->freq;
+		p_delay->smp_num = sps * 60 * beat_num / beat_tempo / p_delay->freq;
 		break;
 	case DELAYUNIT_Second:
-		p_delay->smp_num = MPXTN_SPS / p_delay->freq;
+		p_delay->smp_num = sps / p_delay->freq;
 		break;
 	default:
 		return false;
 	}
 
-	p_delay->p_buf = calloc(p_delay->smp_num * MPXTN_CH, sizeof(s32));
+	p_delay->p_buf    = calloc(p_delay->smp_num * MPXTN_CH, sizeof(s32));
+	p_delay->zero_num = p_delay->smp_num;
 
 	return true;
 }
 
-void delay_tone_supple(DELAY *p_delay, s32 *group_smps, u32 ch)
+void delay_tone_supple(DELAY *p_delay, s32 *p_group, u32 smp_num)
 {
 	if(!p_delay->smp_num) return;
 
-	s32 a = p_delay->p_buf[p_delay->offset * 2 + ch] * p_delay->rate / 100;
-	group_smps[p_delay->group] += a;
-	p_delay->p_buf[p_delay->offset * 2 + ch] = group_smps[p_delay->group];
+	for(u32 i = 0; i < smp_num; ++i) {
+
+		s32 *p_buf = &p_delay->p_buf[p_delay->offset * 2];
+
+		for(u32 ch = 0; ch < MPXTN_CH; ++ch) {
+			s32 a = p_buf[ch] * p_delay->rate / 100;
+			p_group[i * 2 + ch] += a;
+			p_buf[ch] = p_group[i * 2 + ch];
+		}
+
+		if(p_buf[0] || p_buf[1])                       p_delay->zero_num = 0;
+		else if(p_delay->zero_num < p_delay->smp_num) p_delay->zero_num++;
+
+		if(++p_delay->offset >= p_delay->smp_num) p_delay->offset = 0;
+	}
 }
 
-void delay_tone_increment(DELAY *p_delay)
+void delay_tone_clear(DELAY *p_delay)
 {
 	if(!p_delay->smp_num) return;
-	if(++p_delay->offset >= p_delay->smp_num) p_delay->offset = 0;
+	memset(p_delay->p_buf, 0, p_delay->smp_num * MPXTN_CH * sizeof(s32));
+	p_delay->zero_num = p_delay->smp_num;
 }
 
-void delay_tone_clear(DELAY *p_delay)
+/* buffer is all zero, output is silent while input is silent */
+bool delay_tone_drained(const DELAY *p_delay)
+{
+	return p_delay->zero_num >= p_delay->smp_num;
+}
+
+/* same as supple silent input to drained delay */
+void delay_tone_skip(DELAY *p_delay, u32 smp_num)
 {
 	if(!p_delay->smp_num) return;
-	memset(p_delay->p_buf, 0, p_delay->smp_num * MPXTN_CH * sizeof(s32));
+	p_delay->offset = (u32)(((u64)p_delay->offset + smp_num) % p_delay->smp_num);
 }
 
 /* -------------------------------------------------------------------------- */
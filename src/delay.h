@@ -44,16 +44,18 @@ typedef struct {
 	f32 freq;
 	u32 smp_num;
 	u32 offset;
+	u32 zero_num; /* continuous zero samples in p_buf */
 	s32 *p_buf;
 } DELAY;
 
 void delay_free(DELAY *p_delay);
 bool delay_read(DELAY *p_delay, DESCRIPTOR *p_desc);
 
-bool delay_tone_ready(DELAY *p_delay, u32 beat_num, float beat_tempo);
-void delay_tone_supple(DELAY *p_delay, s32 *group_smps, u32 ch);
-void delay_tone_increment(DELAY *p_delay);
+bool delay_tone_ready(DELAY *p_delay, u32 beat_num, float beat_tempo, u32 sps);
+void delay_tone_supple(DELAY *p_delay, s32 *p_group, u32 smp_num);
 void delay_tone_clear(DELAY *p_delay);
+bool delay_tone_drained(const DELAY *p_delay);
+void delay_tone_skip(DELAY *p_delay, u32 smp_num);
 void delay_tone_release(DELAY *p_delay);
 
 #endif
@@ -113,6 +113,21 @@ bool desc_seek(DESCRIPTOR *p_desc, s32 offset, int origin)
 	return true;
 }
 
+bool desc_tell(DESCRIPTOR *p_desc, s32 *p_offset)
+{
+	if(!p_desc) return false;
+	if(!p_desc->p_file && !p_desc->p_mem) return false;
+
+	if(p_desc->p_file) {
+		long pos = ftell(p_desc->p_file);
+		if(pos < 0 || pos > INT32_MAX) return false;
+		*p_offset = (s32)pos;
+	} else {
+		*p_offset = (s32)p_desc->curr;
+	}
+	return true;
+}
+
 bool desc_dat_r(DESCRIPTOR *p_desc, void *p_v, size_t size)
 {
 	if(!p_desc) return false;
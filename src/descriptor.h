@@ -43,6 +43,7 @@ s32 desc_set_file(DESCRIPTOR *p_desc, FILE *p_file);
 
 /* seek */
 bool desc_seek(DESCRIPTOR *p_desc, s32 offset, int origin);
+bool desc_tell(DESCRIPTOR *p_desc, s32 *p_offset);
 
 /* normal read */
 bool desc_dat_r(DESCRIPTOR *p_desc, void *p_v, size_t size);
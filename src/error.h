@@ -57,6 +57,8 @@
 #define MPXTN_EREADPTN      23
 #define MPXTN_EREADOGGV     24
 #define MPXTN_EPREPARE      25
+#define MPXTN_EINVSPS       26 /* unsupported output sample rate */
+#define MPXTN_EINVOPT       27 /* invalid option value */
 
 
 typedef s32 mpxtn_err_t;
@@ -133,7 +133,7 @@ s32 evelist_get_max_clock(EVELIST *p_eve)
 
 }
 
-EVERECORD *evelist_get_records(EVELIST *p_eve)
+const EVERECORD *evelist_get_records(const EVELIST *p_eve)
 {
 	if(!p_eve->size) return NULL;
 	return p_eve->start;
@@ -168,12 +168,23 @@ static void _evelist_linear_add_s32(EVELIST *p_eve, s32 clock, u8 unit_no, u8 ki
 
 void evelist_linear_end(EVELIST *p_eve)
 {
+	EVERECORD *next_ons[UINT8_MAX + 1] = { NULL };
+	u32 r;
+
 	if(p_eve->records[0].kind != 0) p_eve->start = &p_eve->records[0];
-	for(u32 r = 1; r < p_eve->size; ++r) {
+	for(r = 1; r < p_eve->size; ++r) {
 		if(p_eve->records[r].kind == 0) break;
 		p_eve->records[r    ].prev = &p_eve->records[r - 1];
 		p_eve->records[r - 1].next = &p_eve->records[r    ];
 	}
+
+	/* link ON events per unit, from the tail */
+	while(r-- > 0) {
+		EVERECORD *p = &p_eve->records[r];
+		if(p->kind == 0) continue;
+		p->next_on = next_ons[p->unit_no];
+		if(p->kind == EVENTKIND_ON) next_ons[p->unit_no] = p;
+	}
 }
 
 /* -------------------------------------------------------------------------- */
@@ -59,6 +59,7 @@ typedef struct _EVERECORD {
 	s32 clock;
 	struct _EVERECORD *prev;
 	struct _EVERECORD *next;
+	struct _EVERECORD *next_on; /* next ON of the same unit */
 } EVERECORD;
 
 typedef struct {
@@ -85,7 +86,7 @@ bool evelist_check_voiceno(EVELIST *p_eve, u32 woice_num);
 
 s32 evelist_get_max_clock(EVELIST *p_eve);
 
-EVERECORD *evelist_get_records(EVELIST *p_eve);
+const EVERECORD *evelist_get_records(const EVELIST *p_eve);
 
 bool evelist_kind_istail(u8 kind);
 
@@ -0,0 +1,172 @@
+/* -----------------------------------------------------------------------------
+ *  libmpxtn by stkchp
+ * -----------------------------------------------------------------------------
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2017 stkchp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * -------------------------------------------------------------------------- */
+#include "common.h"
+
+#include "fft.h"
+
+static const f64 _pi = 3.1415926535897932;
+
+#define _FACTOR_MAX 32 /* u32 has 32 prime factors at most */
+
+typedef struct {
+	u32  n;
+	u32  factor_num;
+	u32  factors[_FACTOR_MAX];
+	f64 *p_twre;  /* e^(sign 2pi i k / n), k < n */
+	f64 *p_twim;
+	f64 *p_tre;   /* butterfly inputs of the largest factor */
+	f64 *p_tim;
+} _PLAN;
+
+/* -------------------------------------------------------------------------- */
+
+/* primes of n, 2 first */
+static u32 _factorize(u32 n, u32 *p_factors)
+{
+	u32 num = 0;
+
+	for(u32 p = 2; n > 1; p += (p == 2 ? 1 : 2)) {
+		if((u64)p * p > n) p = n;
+		while(n % p == 0) {
+			p_factors[num++] = p;
+			n /= p;
+		}
+	}
+
+	return num;
+}
+
+/* -----------------------------------------------------------------------------
+ * NOTE: decimation in time, out[k] = sum in[j * stride] w^jk for n points,
+ *       w = twiddle[plan.n / n]. input j = q (mod p) goes to the sub transform
+ *       q of n / p points, the sub transforms are combined by radix p butterflies.
+ */
+static void _fft(const _PLAN *p_pl, const f64 *p_re, const f64 *p_im, u32 stride, u32 n, u32 f, f64 *p_ore, f64 *p_oim)
+{
+	if(n == 1) {
+		p_ore[0] = p_re[0];
+		p_oim[0] = p_im[0];
+		return;
+	}
+
+	const f64 *twre = p_pl->p_twre;
+	const f64 *twim = p_pl->p_twim;
+	u32 p    = p_pl->factors[f];
+	u32 m    = n / p;
+	u32 step = p_pl->n / n;
+
+	for(u32 q = 0; q < p; ++q) {
+		_fft(p_pl, p_re + q * stride, p_im + q * stride, stride * p, m, f + 1, p_ore + q * m, p_oim + q * m);
+	}
+
+	if(p == 2) {
+		for(u32 k = 0; k < m; ++k) {
+			f64 c = twre[k * step], s = twim[k * step];
+			f64 tre = p_ore[k + m] * c - p_oim[k + m] * s;
+			f64 tim = p_ore[k + m] * s + p_oim[k + m] * c;
+			f64 ere = p_ore[k], eim = p_oim[k];
+
+			p_ore[k    ] = ere + tre;
+			p_oim[k    ] = eim + tim;
+			p_ore[k + m] = ere - tre;
+			p_oim[k + m] = eim - tim;
+		}
+		return;
+	}
+
+	f64 *tre = p_pl->p_tre;
+	f64 *tim = p_pl->p_tim;
+	u32 pstep = m * step; /* w of p points */
+
+	for(u32 k = 0; k < m; ++k) {
+
+		/* twiddled inputs */
+		tre[0] = p_ore[k];
+		tim[0] = p_oim[k];
+		for(u32 q = 1; q < p; ++q) {
+			u32 e = q * k * step;
+			f64 c = twre[e], s = twim[e];
+			f64 re = p_ore[q * m + k], im = p_oim[q * m + k];
+
+			tre[q] = re * c - im * s;
+			tim[q] = re * s + im * c;
+		}
+
+		/* dft of p points */
+		for(u32 r = 0; r < p; ++r) {
+			f64 re = tre[0], im = tim[0];
+			u32 e = 0;
+
+			for(u32 q = 1; q < p; ++q) {
+				e += r;
+				if(e >= p) e -= p;
+
+				f64 c = twre[e * pstep], s = twim[e * pstep];
+				re += tre[q] * c - tim[q] * s;
+				im += tre[q] * s + tim[q] * c;
+			}
+			p_ore[r * m + k] = re;
+			p_oim[r * m + k] = im;
+		}
+	}
+}
+
+bool fft(const f64 *p_re, const f64 *p_im, u32 n, bool inverse, f64 *p_ore, f64 *p_oim)
+{
+	_PLAN pl;
+	u32 max = 0;
+	f64 sign = inverse ? 1.0 : -1.0;
+
+	if(!n) return true;
+
+	pl.n          = n;
+	pl.factor_num = _factorize(n, pl.factors);
+
+	for(u32 i = 0; i < pl.factor_num; ++i) {
+		if(pl.factors[i] > max) max = pl.factors[i];
+	}
+
+	/* twiddles and the scratch in one */
+	pl.p_twre = malloc(sizeof(f64) * ((size_t)n + max) * 2);
+	if(!pl.p_twre) return false;
+
+	pl.p_twim = pl.p_twre + n;
+	pl.p_tre  = pl.p_twim + n;
+	pl.p_tim  = pl.p_tre  + max;
+
+	for(u32 k = 0; k < n; ++k) {
+		f64 a = sign * 2 * _pi * k / n;
+		pl.p_twre[k] = cos(a);
+		pl.p_twim[k] = sin(a);
+	}
+
+	_fft(&pl, p_re, p_im, 1, n, 0, p_ore, p_oim);
+
+	free(pl.p_twre);
+	return true;
+}
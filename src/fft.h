@@ -0,0 +1,39 @@
+/* -----------------------------------------------------------------------------
+ *  libmpxtn by stkchp
+ * -----------------------------------------------------------------------------
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2017 stkchp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * -------------------------------------------------------------------------- */
+#ifndef MPXTNLIB_FFT_H
+#define MPXTNLIB_FFT_H
+
+#include "common.h"
+
+/* complex dft of p_re/p_im[n] to p_ore/p_oim[n], in != out.
+ * inverse: e^(+i), not scaled by 1 / n.
+ * mixed radix of the prime factors of n, n x (sum of the factors) operations.
+ * false if out of memory. */
+bool fft(const f64 *p_re, const f64 *p_im, u32 n, bool inverse, f64 *p_ore, f64 *p_oim);
+
+#endif
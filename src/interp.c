@@ -0,0 +1,366 @@
+/* -----------------------------------------------------------------------------
+ *  libmpxtn by stkchp
+ * -----------------------------------------------------------------------------
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2017 stkchp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * -------------------------------------------------------------------------- */
+#include "common.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define _INTERP_SSE2
+#endif
+
+#include "interp.h"
+
+#define _SINC_TAP         8
+#define _SINC_PHASE_BITS  7
+#define _SINC_PHASE       (1 << _SINC_PHASE_BITS)
+#define _SINC_SHIFT       14
+
+/* blackman windowed sinc, tap t is for sample (i + t - 3), sum of each phase is 1 << 14 */
+static const s16 _sinc_table[_SINC_PHASE][_SINC_TAP] = {
+	{     0,      0,      0,  16384,      0,      0,      0,      0 },
+	{    -3,     21,    -98,  16383,    100,    -22,      3,      0 },
+	{    -5,     42,   -193,  16376,    203,    -45,      6,      0 },
+	{    -8,     63,   -286,  16366,    308,    -68,      9,      0 },
+	{   -10,     82,   -377,  16353,    415,    -91,     12,      0 },
+	{   -13,    102,   -465,  16336,    524,   -116,     16,      0 },
+	{   -15,    120,   -551,  16316,    636,   -141,     19,      0 },
+	{   -17,    138,   -635,  16291,    750,   -166,     23,      0 },
+	{   -19,    156,   -716,  16263,    866,   -192,     26,      0 },
+	{   -21,    173,   -795,  16230,    985,   -218,     30,      0 },
+	{   -23,    189,   -871,  16194,   1106,   -245,     34,      0 },
+	{   -24,    205,   -945,  16153,   1229,   -272,     38,      0 },
+	{   -26,    220,  -1017,  16110,   1354,   -300,     43,      0 },
+	{   -27,    234,  -1086,  16063,   1481,   -328,     47,      0 },
+	{   -29,    248,  -1153,  16014,   1610,   -357,     51,      0 },
+	{   -30,    262,  -1218,  15959,   1741,   -386,     56,      0 },
+	{   -31,    275,  -1280,  15900,   1875,   -416,     61,      0 },
+	{   -32,    287,  -1340,  15841,   2010,   -446,     65,     -1 },
+	{   -33,    299,  -1397,  15774,   2148,   -476,     70,     -1 },
+	{   -34,    310,  -1453,  15707,   2287,   -507,     75,     -1 },
+	{   -35,    321,  -1505,  15634,   2428,   -538,     80,     -1 },
+	{   -36,    331,  -1556,  15558,   2572,   -570,     86,     -1 },
+	{   -37,    340,  -1604,  15479,   2717,   -601,     91,     -1 },
+	{   -37,    349,  -1651,  15399,   2863,   -634,     96,     -1 },
+	{   -38,    358,  -1694,  15311,   3012,   -666,    102,     -1 },
+	{   -38,    366,  -1736,  15223,   3162,   -699,    108,     -2 },
+	{   -39,    373,  -1776,  15133,   3314,   -732,    113,     -2 },
+	{   -39,    380,  -1813,  15036,   3468,   -765,    119,     -2 },
+	{   -39,    386,  -1848,  14938,   3623,   -799,    125,     -2 },
+	{   -39,    392,  -1881,  14836,   3780,   -832,    131,     -3 },
+	{   -40,    398,  -1912,  14732,   3938,   -866,    137,     -3 },
+	{   -40,    403,  -1941,  14625,   4097,   -900,    143,     -3 },
+	{   -40,    407,  -1968,  14515,   4258,   -935,    150,     -3 },
+	{   -40,    411,  -1992,  14401,   4421,   -969,    156,     -4 },
+	{   -39,    415,  -2015,  14284,   4584,  -1003,    162,     -4 },
+	{   -39,    418,  -2036,  14165,   4749,  -1038,    169,     -4 },
+	{   -39,    421,  -2055,  14044,   4915,  -1072,    175,     -5 },
+	{   -39,    423,  -2072,  13919,   5082,  -1106,    182,     -5 },
+	{   -38,    425,  -2087,  13792,   5250,  -1141,    189,     -6 },
+	{   -38,    426,  -2100,  13663,   5419,  -1175,    195,     -6 },
+	{   -38,    427,  -2111,  13532,   5589,  -1210,    202,     -7 },
+	{   -37,    428,  -2121,  13396,   5760,  -1244,    209,     -7 },
+	{   -37,    428,  -2129,  13259,   5932,  -1278,    216,     -7 },
+	{   -36,    428,  -2135,  13121,   6104,  -1312,    222,     -8 },
+	{   -36,    428,  -2139,  12977,   6278,  -1345,    229,     -8 },
+	{   -35,    427,  -2142,  12835,   6451,  -1379,    236,     -9 },
+	{   -35,    426,  -2143,  12689,   6626,  -1412,    243,    -10 },
+	{   -34,    424,  -2143,  12541,   6801,  -1445,    250,    -10 },
+	{   -34,    422,  -2141,  12393,   6976,  -1478,    257,    -11 },
+	{   -33,    420,  -2137,  12240,   7152,  -1510,    263,    -11 },
+	{   -32,    418,  -2132,  12086,   7328,  -1542,    270,    -12 },
+	{   -32,    415,  -2126,  11932,   7504,  -1573,    277,    -13 },
+	{   -31,    412,  -2118,  11774,   7680,  -1604,    284,    -13 },
+	{   -30,    409,  -2109,  11617,   7856,  -1635,    290,    -14 },
+	{   -29,    406,  -2098,  11455,   8033,  -1665,    297,    -15 },
+	{   -29,    402,  -2086,  11293,   8209,  -1694,    304,    -15 },
+	{   -28,    398,  -2073,  11131,   8385,  -1723,    310,    -16 },
+	{   -27,    394,  -2059,  10965,   8562,  -1751,    317,    -17 },
+	{   -26,    389,  -2043,  10799,   8737,  -1778,    323,    -17 },
+	{   -26,    385,  -2027,  10633,   8913,  -1805,    329,    -18 },
+	{   -25,    380,  -2009,  10465,   9088,  -1831,    335,    -19 },
+	{   -24,    375,  -1990,  10297,   9262,  -1857,    341,    -20 },
+	{   -23,    370,  -1970,  10125,   9436,  -1881,    347,    -20 },
+	{   -23,    364,  -1949,   9955,   9610,  -1905,    353,    -21 },
+	{   -22,    359,  -1928,   9783,   9783,  -1928,    359,    -22 },
+	{   -21,    353,  -1905,   9610,   9955,  -1949,    364,    -23 },
+	{   -20,    347,  -1881,   9436,  10125,  -1970,    370,    -23 },
+	{   -20,    341,  -1857,   9262,  10297,  -1990,    375,    -24 },
+	{   -19,    335,  -1831,   9088,  10465,  -2009,    380,    -25 },
+	{   -18,    329,  -1805,   8913,  10633,  -2027,    385,    -26 },
+	{   -17,    323,  -1778,   8737,  10799,  -2043,    389,    -26 },
+	{   -17,    317,  -1751,   8562,  10965,  -2059,    394,    -27 },
+	{   -16,    310,  -1723,   8385,  11131,  -2073,    398,    -28 },
+	{   -15,    304,  -1694,   8209,  11293,  -2086,    402,    -29 },
+	{   -15,    297,  -1665,   8033,  11455,  -2098,    406,    -29 },
+	{   -14,    290,  -1635,   7856,  11617,  -2109,    409,    -30 },
+	{   -13,    284,  -1604,   7680,  11774,  -2118,    412,    -31 },
+	{   -13,    277,  -1573,   7504,  11932,  -2126,    415,    -32 },
+	{   -12,    270,  -1542,   7328,  12086,  -2132,    418,    -32 },
+	{   -11,    263,  -1510,   7152,  12240,  -2137,    420,    -33 },
+	{   -11,    257,  -1478,   6976,  12393,  -2141,    422,    -34 },
+	{   -10,    250,  -1445,   6801,  12541,  -2143,    424,    -34 },
+	{   -10,    243,  -1412,   6626,  12689,  -2143,    426,    -35 },
+	{    -9,    236,  -1379,   6451,  12835,  -2142,    427,    -35 },
+	{    -8,    229,  -1345,   6278,  12977,  -2139,    428,    -36 },
+	{    -8,    222,  -1312,   6104,  13121,  -2135,    428,    -36 },
+	{    -7,    216,  -1278,   5932,  13259,  -2129,    428,    -37 },
+	{    -7,    209,  -1244,   5760,  13396,  -2121,    428,    -37 },
+	{    -7,    202,  -1210,   5589,  13532,  -2111,    427,    -38 },
+	{    -6,    195,  -1175,   5419,  13663,  -2100,    426,    -38 },
+	{    -6,    189,  -1141,   5250,  13792,  -2087,    425,    -38 },
+	{    -5,    182,  -1106,   5082,  13919,  -2072,    423,    -39 },
+	{    -5,    175,  -1072,   4915,  14044,  -2055,    421,    -39 },
+	{    -4,    169,  -1038,   4749,  14165,  -2036,    418,    -39 },
+	{    -4,    162,  -1003,   4584,  14284,  -2015,    415,    -39 },
+	{    -4,    156,   -969,   4421,  14401,  -1992,    411,    -40 },
+	{    -3,    150,   -935,   4258,  14515,  -1968,    407,    -40 },
+	{    -3,    143,   -900,   4097,  14625,  -1941,    403,    -40 },
+	{    -3,    137,   -866,   3938,  14732,  -1912,    398,    -40 },
+	{    -3,    131,   -832,   3780,  14836,  -1881,    392,    -39 },
+	{    -2,    125,   -799,   3623,  14938,  -1848,    386,    -39 },
+	{    -2,    119,   -765,   3468,  15036,  -1813,    380,    -39 },
+	{    -2,    113,   -732,   3314,  15133,  -1776,    373,    -39 },
+	{    -2,    108,   -699,   3162,  15223,  -1736,    366,    -38 },
+	{    -1,    102,   -666,   3012,  15311,  -1694,    358,    -38 },
+	{    -1,     96,   -634,   2863,  15399,  -1651,    349,    -37 },
+	{    -1,     91,   -601,   2717,  15479,  -1604,    340,    -37 },
+	{    -1,     86,   -570,   2572,  15558,  -1556,    331,    -36 },
+	{    -1,     80,   -538,   2428,  15634,  -1505,    321,    -35 },
+	{    -1,     75,   -507,   2287,  15707,  -1453,    310,    -34 },
+	{    -1,     70,   -476,   2148,  15774,  -1397,    299,    -33 },
+	{    -1,     65,   -446,   2010,  15841,  -1340,    287,    -32 },
+	{     0,     61,   -416,   1875,  15900,  -1280,    275,    -31 },
+	{     0,     56,   -386,   1741,  15959,  -1218,    262,    -30 },
+	{     0,     51,   -357,   1610,  16014,  -1153,    248,    -29 },
+	{     0,     47,   -328,   1481,  16063,  -1086,    234,    -27 },
+	{     0,     43,   -300,   1354,  16110,  -1017,    220,    -26 },
+	{     0,     38,   -272,   1229,  16153,   -945,    205,    -24 },
+	{     0,     34,   -245,   1106,  16194,   -871,    189,    -23 },
+	{     0,     30,   -218,    985,  16230,   -795,    173,    -21 },
+	{     0,     26,   -192,    866,  16263,   -716,    156,    -19 },
+	{     0,     23,   -166,    750,  16291,   -635,    138,    -17 },
+	{     0,     19,   -141,    636,  16316,   -551,    120,    -15 },
+	{     0,     16,   -116,    524,  16336,   -465,    102,    -13 },
+	{     0,     12,    -91,    415,  16353,   -377,     82,    -10 },
+	{     0,      9,    -68,    308,  16366,   -286,     63,     -8 },
+	{     0,      6,    -45,    203,  16376,   -193,     42,     -5 },
+	{     0,      3,    -22,    100,  16383,    -98,     21,     -3 },
+};
+
+/* -------------------------------------------------------------------------- */
+
+/* all taps from (i + ofs) are in the woice */
+static inline bool _inside(u32 smp_num, u32 i, s32 ofs, u32 tap_num)
+{
+	s64 top = (s64)i + ofs;
+	return top >= 0 && top + tap_num <= smp_num;
+}
+
+/* samples from (i + ofs), outside of the woice is wrapped if looped, else zero */
+static void _fetch(const s16 *smps, u32 smp_num, u8 smp_ch, bool loop, u32 i, s32 ofs, u32 tap_num, s32 (*p_w)[_SINC_TAP])
+{
+	s64 top = (s64)i + ofs;
+	u32 c;
+
+	if(_inside(smp_num, i, ofs, tap_num)) {
+		const s16 *p = &smps[top * smp_ch];
+		for(u32 t = 0; t < tap_num; ++t) {
+			for(c = 0; c < smp_ch; ++c) p_w[c][t] = p[t * smp_ch + c];
+		}
+		return;
+	}
+
+	for(u32 t = 0; t < tap_num; ++t) {
+		s64 idx = top + t;
+
+		if(idx < 0 || idx >= smp_num) {
+			if(!loop) {
+				for(c = 0; c < smp_ch; ++c) p_w[c][t] = 0;
+				continue;
+			}
+			idx %= smp_num;
+			if(idx < 0) idx += smp_num;
+		}
+
+		for(c = 0; c < smp_ch; ++c) p_w[c][t] = smps[idx * smp_ch + c];
+	}
+}
+
+#ifdef _INTERP_SSE2
+/* -----------------------------------------------------------------------------
+ * NOTE: kernels for taps inside of the woice, same results as the scalar code.
+ *       mono linear and cubic have too few products, they are scalar only.
+ */
+
+/* lane 0: sum of a, lane 1: sum of b */
+static inline __m128i _hsum2(__m128i a, __m128i b)
+{
+	__m128i t = _mm_add_epi32(_mm_unpacklo_epi32(a, b), _mm_unpackhi_epi32(a, b));
+	return _mm_add_epi32(t, _mm_srli_si128(t, 8));
+}
+
+static inline void _store2(__m128i x, s32 *p_works)
+{
+	p_works[0] = _mm_cvtsi128_si32(x);
+	p_works[1] = _mm_cvtsi128_si32(_mm_srli_si128(x, 4));
+}
+
+/* stereo, w0 + ((w1 - w0) * t >> 15) */
+static void _linear_sse2(const s16 *p, s32 t, s32 *p_works)
+{
+	__m128i x = _mm_loadl_epi64((const __m128i*)p);
+
+	/* L0 L1 R0 R1, (w1 - w0) * t by pmaddwd */
+	x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(3, 1, 2, 0));
+	__m128i d  = _mm_madd_epi16(x, _mm_set_epi16(0, 0, 0, 0, (s16)t, (s16)-t, (s16)t, (s16)-t));
+	__m128i w0 = _mm_srai_epi32(_mm_slli_epi32(x, 16), 16);
+
+	_store2(_mm_add_epi32(w0, _mm_srai_epi32(d, 15)), p_works);
+}
+
+/* stereo catmull-rom, lanes 0 and 1 are calculated in the same order as scalar */
+static void _cubic_sse2(const s16 *p, f32 t, s32 *p_works)
+{
+	__m128i x   = _mm_loadu_si128((const __m128i*)p);
+	__m128  v01 = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16));
+	__m128  v23 = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16));
+
+	__m128 y0 = v01, y1 = _mm_movehl_ps(v01, v01);
+	__m128 y2 = v23, y3 = _mm_movehl_ps(v23, v23);
+	__m128 tt = _mm_set1_ps(t);
+
+	__m128 a = _mm_mul_ps(_mm_set1_ps(-0.5f), y0);
+	a = _mm_add_ps(a, _mm_mul_ps(_mm_set1_ps(1.5f), y1));
+	a = _mm_sub_ps(a, _mm_mul_ps(_mm_set1_ps(1.5f), y2));
+	a = _mm_add_ps(a, _mm_mul_ps(_mm_set1_ps(0.5f), y3));
+
+	__m128 b = _mm_sub_ps(y0, _mm_mul_ps(_mm_set1_ps(2.5f), y1));
+	b = _mm_add_ps(b, _mm_mul_ps(_mm_set1_ps(2.0f), y2));
+	b = _mm_sub_ps(b, _mm_mul_ps(_mm_set1_ps(0.5f), y3));
+
+	__m128 c = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(-0.5f), y0), _mm_mul_ps(_mm_set1_ps(0.5f), y2));
+
+	__m128 y = _mm_add_ps(_mm_mul_ps(a, tt), b);
+	y = _mm_add_ps(_mm_mul_ps(y, tt), c);
+	y = _mm_add_ps(_mm_mul_ps(y, tt), y1);
+
+	_store2(_mm_cvttps_epi32(y), p_works);
+}
+
+/* 8 taps Q14 by pmaddwd, stereo takes the channel by zero interleaved coefficients */
+static void _sinc_sse2(const s16 *p, u8 smp_ch, const s16 *p_c, s32 *p_works)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i c = _mm_loadu_si128((const __m128i*)p_c);
+	__m128i x0 = _mm_loadu_si128((const __m128i*)p);
+
+	if(smp_ch == 1) {
+		__m128i s = _mm_madd_epi16(x0, c);
+		p_works[0] = _mm_cvtsi128_si32(_mm_srai_epi32(_hsum2(s, s), _SINC_SHIFT));
+		return;
+	}
+
+	__m128i x1 = _mm_loadu_si128((const __m128i*)(p + 8));
+	__m128i l  = _mm_add_epi32(_mm_madd_epi16(x0, _mm_unpacklo_epi16(c, zero)), _mm_madd_epi16(x1, _mm_unpackhi_epi16(c, zero)));
+	__m128i r  = _mm_add_epi32(_mm_madd_epi16(x0, _mm_unpacklo_epi16(zero, c)), _mm_madd_epi16(x1, _mm_unpackhi_epi16(zero, c)));
+
+	_store2(_mm_srai_epi32(_hsum2(l, r), _SINC_SHIFT), p_works);
+}
+#endif
+
+void interp_sample(const s16 *smps, u32 smp_num, u8 smp_ch, bool loop, u64 pos, u8 interp, s32 *p_works)
+{
+	u32 i    = (u32)(pos >> 32);
+	u32 frac = (u32)pos;
+	s32 w[MPXTN_CH][_SINC_TAP];
+	u32 ch;
+
+	switch(interp)
+	{
+	case INTERP_LINEAR:
+	{
+		s32 t = (s32)(frac >> 17);
+
+#ifdef _INTERP_SSE2
+		if(smp_ch == MPXTN_CH && _inside(smp_num, i, 0, 2)) {
+			_linear_sse2(&smps[i * MPXTN_CH], t, p_works);
+			break;
+		}
+#endif
+		_fetch(smps, smp_num, smp_ch, loop, i, 0, 2, w);
+		for(ch = 0; ch < smp_ch; ++ch) {
+			p_works[ch] = w[ch][0] + (((w[ch][1] - w[ch][0]) * t) >> 15);
+		}
+		break;
+	}
+	case INTERP_CUBIC:
+	{
+		f32 t = (f32)frac * (1.0f / 4294967296.0f);
+
+#ifdef _INTERP_SSE2
+		if(smp_ch == MPXTN_CH && _inside(smp_num, i, -1, 4)) {
+			_cubic_sse2(&smps[(i - 1) * MPXTN_CH], t, p_works);
+			break;
+		}
+#endif
+		/* catmull-rom */
+		_fetch(smps, smp_num, smp_ch, loop, i, -1, 4, w);
+		for(ch = 0; ch < smp_ch; ++ch) {
+			f32 y0 = (f32)w[ch][0], y1 = (f32)w[ch][1], y2 = (f32)w[ch][2], y3 = (f32)w[ch][3];
+			f32 a = -0.5f * y0 + 1.5f * y1 - 1.5f * y2 + 0.5f * y3;
+			f32 b =         y0 - 2.5f * y1 + 2.0f * y2 - 0.5f * y3;
+			f32 c = -0.5f * y0             + 0.5f * y2;
+			p_works[ch] = (s32)(((a * t + b) * t + c) * t + y1);
+		}
+		break;
+	}
+	case INTERP_SINC:
+	{
+		const s16 *p_c = _sinc_table[frac >> (32 - _SINC_PHASE_BITS)];
+
+#ifdef _INTERP_SSE2
+		if(_inside(smp_num, i, -(_SINC_TAP / 2 - 1), _SINC_TAP)) {
+			_sinc_sse2(&smps[(i - (_SINC_TAP / 2 - 1)) * smp_ch], smp_ch, p_c, p_works);
+			break;
+		}
+#endif
+		_fetch(smps, smp_num, smp_ch, loop, i, -(_SINC_TAP / 2 - 1), _SINC_TAP, w);
+		for(ch = 0; ch < smp_ch; ++ch) {
+			s32 sum = 0;
+			for(u32 t = 0; t < _SINC_TAP; ++t) sum += w[ch][t] * p_c[t];
+			p_works[ch] = sum >> _SINC_SHIFT;
+		}
+		break;
+	}
+	default:
+		for(ch = 0; ch < smp_ch; ++ch) p_works[ch] = smps[i * smp_ch + ch];
+		break;
+	}
+
+	/* mono is played on both channels */
+	if(smp_ch == 1) p_works[1] = p_works[0];
+}
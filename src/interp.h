@@ -0,0 +1,47 @@
+/* -----------------------------------------------------------------------------
+ *  libmpxtn by stkchp
+ * -----------------------------------------------------------------------------
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2017 stkchp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * -------------------------------------------------------------------------- */
+#ifndef MPXTNLIB_INTERP_H
+#define MPXTNLIB_INTERP_H
+
+#include "common.h"
+
+/* same as MPXTN_INTERP_* */
+enum INTERP {
+	INTERP_NONE  ,// 0 nearest
+	INTERP_LINEAR,// 1
+	INTERP_CUBIC ,// 2 4 points
+	INTERP_SINC  ,// 3 8 points
+
+	INTERP_NUM   ,// 4
+};
+
+/* stereo sample at pos (32.32 fixed point), p_works[MPXTN_CH]
+ * smp_ch: channels of smps, 1 or MPXTN_CH */
+void interp_sample(const s16 *smps, u32 smp_num, u8 smp_ch, bool loop, u64 pos, u8 interp, s32 *p_works);
+
+#endif
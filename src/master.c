@@ -38,7 +38,7 @@ u32 master_get_last_clock(MASTER *p_m)
 	return p_m->meas_last * p_m->beat_clock * p_m->beat_num;
 }
 
-u32 master_get_play_meas(MASTER *p_m)
+u32 master_get_play_meas(const MASTER *p_m)
 {
 	if(p_m->meas_last) return p_m->meas_last;
 	else               return p_m->meas_num;
@@ -46,6 +46,6 @@ void master_adjust_meas_num(MASTER *p_master, u32 clock);
 
 /* util */
 u32 master_get_last_clock(MASTER *p_master);
-u32 master_get_play_meas(MASTER *p_master);
+u32 master_get_play_meas(const MASTER *p_master);
 
 #endif
@@ -31,7 +31,26 @@
 
 #include "descriptor.h"
 #include "freq.h"
+#include "interp.h"
+#include "resample.h"
 #include "service.h"
+#include "unit.h"
+#include "wcache.h"
+
+struct _MPXTN_SONG {
+	s32     ref;
+	SERVICE srv;
+};
+
+/* playback state at a block boundary, to restore on seek */
+typedef struct {
+	u32 smp_count;
+	u32 time_pan_idx;
+	const EVERECORD *p_eve;
+	UNIT  *units;
+	DELAY *delays;     /* p_buf is not used */
+	s32   *delay_bufs; /* buffers of undrained delays, packed */
+} _SNAPSHOT;
 
 struct _MPXTN {
 	bool end_vomit;
@@ -50,43 +69,67 @@ struct _MPXTN {
 	u32 smp_end;
 	u32 smp_count;
 	s32 smp_smooth;
+	u8  interp;
 
 	u32 time_pan_idx;
 	s32 top;
 
 	s32 clock;
 
+	bool silent;  /* last block is silent, buffers are not filled */
+	bool discard; /* rendered samples are not used, skip mixing */
+
+	u32 delay_groups; /* bit per group read by delays */
+
 	const EVERECORD *p_eve;
 
-	SERVICE srv;
+	MPXTN_SONG    *p_song;
+	const SERVICE *p_srv;
 
-	s16 smp_data[2];
-	s32 group_smps[GROUP_MAX];
+	UNIT  *units;
+	DELAY *delays;
+
+	/* index of units not culled, updated by ON events and rendering */
+	u32 *actives;
+	u32 active_num;
+
+	_SNAPSHOT *snaps;
+	u32 snap_num;
+
+	s32 group_bufs[GROUP_MAX][BUFSIZE_RENDER * MPXTN_CH];
+	s32 mix_buf[BUFSIZE_RENDER * MPXTN_CH];
 };
 
+typedef enum {
+	_VOMIT_S16,
+	_VOMIT_S32,
+	_VOMIT_F32,
+	_VOMIT_GROUPS,
+} _VOMITTYPE;
+
 /* -------------------------------------------------------------------------- */
 
 static bool _prepare(MPXTN *mp);
 static bool _reset_voice_on(MPXTN *mp, UNIT *p_u, s32 idx);
 static bool _init_unit_tone(MPXTN *mp);
+static void _free_snapshots(MPXTN *mp);
 
 /* -------------------------------------------------------------------------- */
 
 static bool _prepare(MPXTN *mp)
 {
 	if(!mp) return false;
-	if(!mp->srv.valid) return false;
 
 	mp->end_vomit = false;
 	mp->loop = false;
 
 	/* save freq used value */
-	mp->beat_num   = mp->srv.master.beat_num;
-	mp->beat_clock = mp->srv.master.beat_clock;
-	mp->beat_tempo = (f64)mp->srv.master.beat_tempo;
+	mp->beat_num   = mp->p_srv->master.beat_num;
+	mp->beat_clock = mp->p_srv->master.beat_clock;
+	mp->beat_tempo = (f64)mp->p_srv->master.beat_tempo;
 
-	mp->meas_repeat = mp->srv.master.meas_repeat;
-	mp->meas_end    = master_get_play_meas(&mp->srv.master);
+	mp->meas_repeat = mp->p_srv->master.meas_repeat;
+	mp->meas_end    = master_get_play_meas(&mp->p_srv->master);
 
 	u32 clk_per_meas   = mp->beat_clock * mp->beat_num;
 	u32 clk_per_minute = (u32)(mp->beat_tempo * mp->beat_clock);
@@ -94,7 +137,7 @@ static bool _prepare(MPXTN *mp)
 	u32 clk_repeat = mp->meas_repeat * clk_per_meas;
 	u32 clk_end    = mp->meas_end    * clk_per_meas;
 
-	mp->smp_per_clk = 60.0 * MPXTN_SPS / clk_per_minute;
+	mp->smp_per_clk = 60.0 * mp->p_srv->sps / clk_per_minute;
 
 	mp->smp_repeat = (u32)(clk_repeat * mp->smp_per_clk);
 	mp->smp_end    = (u32)(clk_end    * mp->smp_per_clk);
@@ -102,14 +145,16 @@ static bool _prepare(MPXTN *mp)
 	mp->time_pan_idx = 0;
 
 	mp->smp_count  = 0;
-	mp->smp_smooth = MPXTN_SPS / 250; /* 4ms */
+	mp->smp_smooth = (s32)(mp->p_srv->sps / 250); /* 4ms */
 
-	mp->p_eve = evelist_get_records(&mp->srv.evels);
+	mp->p_eve = evelist_get_records(&mp->p_srv->evels);
 	mp->top = INT16_MAX;
 
 	/* ready tones */
-	for(u32 i = 0; i < mp->srv.delay_num; ++i) {
-		delay_tone_ready(&mp->srv.delays[i], mp->beat_num, mp->beat_tempo);
+	mp->delay_groups = 0;
+	for(u32 i = 0; i < mp->p_srv->delay_num; ++i) {
+		delay_tone_ready(&mp->delays[i], mp->beat_num, mp->beat_tempo, mp->p_srv->sps);
+		mp->delay_groups |= 1u << mp->delays[i].group;
 	}
 
 
@@ -120,36 +165,74 @@ static bool _prepare(MPXTN *mp)
 
 /* -------------------------------------------------------------------------- */
 
-static MPXTN *_common_read(DESCRIPTOR *p_desc, int *err)
+static MPXTN_SONG *_song_read(DESCRIPTOR *p_desc, const MPXTN_OPTION *opt, int *err)
 {
-	MPXTN *mp;
+	MPXTN_SONG *song = NULL;
+	SERVICE_OPTION srv_opt = { MPXTN_SPS, RESAMPLE_NEAREST, 1, false, false, 0, 0 };
 	mpxtn_err_t ret = MPXTN_NOERR;
 
-	mp = calloc(1, sizeof(MPXTN));
-	if(!mp) {
+	if(opt) {
+		if(opt->sps) srv_opt.sps = opt->sps;
+		if(opt->resample < 0 || opt->resample >= RESAMPLE_NUM) {
+			ret = MPXTN_EINVOPT;
+			goto End;
+		}
+		srv_opt.resample      = (u8)opt->resample;
+		if(opt->ptv_scale) srv_opt.ptv_scale = opt->ptv_scale;
+		srv_opt.ptv_mipmap    = opt->ptv_mipmap;
+		srv_opt.lazy_woice    = opt->lazy_woice;
+		srv_opt.woice_threads = opt->woice_threads;
+		srv_opt.ptn_threads   = opt->ptn_threads;
+	}
+
+	song = calloc(1, sizeof(MPXTN_SONG));
+	if(!song) {
 		ret = MPXTN_ENOMEM;
 		goto End;
 	}
 
-	ret = service_read(&mp->srv, p_desc);
-	if(ret != MPXTN_NOERR) goto End;
+	song->ref = 1;
 
-	if(!_prepare(mp)) {
-		ret = MPXTN_EPREPARE;
-		goto End;
-	}
+	ret = service_read(&song->srv, p_desc, &srv_opt);
+	if(ret != MPXTN_NOERR) goto End;
 
 End:
+	if(err) *err = ret;
+
 	if(ret != MPXTN_NOERR) {
-		mpxtn_close(mp);
+		mpxtn_song_close(song);
 		return NULL;
 	}
 
-	if(err) *err = ret;
+	return song;
+}
+
+static MPXTN *_common_read(DESCRIPTOR *p_desc, const MPXTN_OPTION *opt, int *err)
+{
+	MPXTN_SONG *song = NULL;
+	MPXTN *mp;
+
+	song = _song_read(p_desc, opt, err);
+	if(!song) return NULL;
+
+	/* player keeps the reference */
+	mp = mpxtn_open(song, err);
+	mpxtn_song_close(song);
+
 	return mp;
 }
 
 MPXTN_API MPXTN *mpxtn_fread(FILE *fp, int *err)
+{
+	return mpxtn_fread_opt(fp, NULL, err);
+}
+
+MPXTN_API MPXTN *mpxtn_mread(const void *p, size_t size, int *err)
+{
+	return mpxtn_mread_opt(p, size, NULL, err);
+}
+
+MPXTN_API MPXTN *mpxtn_fread_opt(FILE *fp, const MPXTN_OPTION *opt, int *err)
 {
 	s32 ret = MPXTN_NOERR;
 	DESCRIPTOR desc;
@@ -161,10 +244,10 @@ MPXTN_API MPXTN *mpxtn_fread(FILE *fp, int *err)
 		return NULL;
 	}
 
-	return _common_read(&desc, err);
+	return _common_read(&desc, opt, err);
 }
 
-MPXTN_API MPXTN *mpxtn_mread(const void *p, size_t size, int *err)
+MPXTN_API MPXTN *mpxtn_mread_opt(const void *p, size_t size, const MPXTN_OPTION *opt, int *err)
 {
 	s32 ret = MPXTN_NOERR;
 	DESCRIPTOR desc;
@@ -176,15 +259,129 @@ MPXTN_API MPXTN *mpxtn_mread(const void *p, size_t size, int *err)
 		return NULL;
 	}
 
-	return _common_read(&desc, err);
+	return _common_read(&desc, opt, err);
 }
 
 /* -------------------------------------------------------------------------- */
 
+MPXTN_API MPXTN_SONG *mpxtn_song_fread(FILE *fp, const MPXTN_OPTION *opt, int *err)
+{
+	s32 ret = MPXTN_NOERR;
+	DESCRIPTOR desc;
+
+	ret = desc_set_file(&desc, fp);
+
+	if(ret != MPXTN_NOERR) {
+		if(err) *err = ret;
+		return NULL;
+	}
+
+	return _song_read(&desc, opt, err);
+}
+
+MPXTN_API MPXTN_SONG *mpxtn_song_mread(const void *p, size_t size, const MPXTN_OPTION *opt, int *err)
+{
+	s32 ret = MPXTN_NOERR;
+	DESCRIPTOR desc;
+
+	ret = desc_set_memory(&desc, p, size);
+
+	if(ret != MPXTN_NOERR) {
+		if(err) *err = ret;
+		return NULL;
+	}
+
+	return _song_read(&desc, opt, err);
+}
+
+MPXTN_API void mpxtn_song_close(MPXTN_SONG *song)
+{
+	if(!song) return;
+
+	/* still used by players */
+	if(ref_dec(&song->ref) > 0) return;
+
+	service_free(&song->srv);
+	free(song);
+}
+
+MPXTN_API void mpxtn_set_woice_cache(size_t budget)
+{
+	wcache_set_budget(budget);
+}
+
+/* -------------------------------------------------------------------------- */
+
+MPXTN_API MPXTN *mpxtn_open(MPXTN_SONG *song, int *err)
+{
+	MPXTN *mp = NULL;
+	mpxtn_err_t ret = MPXTN_NOERR;
+
+	if(!song) {
+		ret = MPXTN_EINTERNAL;
+		goto End;
+	}
+
+	mp = calloc(1, sizeof(MPXTN));
+	if(!mp) {
+		ret = MPXTN_ENOMEM;
+		goto End;
+	}
+
+	ref_inc(&song->ref);
+	mp->p_song = song;
+	mp->p_srv  = &song->srv;
+
+	/* player own tones */
+	if(mp->p_srv->unit_num) {
+		mp->units      = calloc(mp->p_srv->unit_num, sizeof(UNIT));
+		mp->actives    = calloc(mp->p_srv->unit_num, sizeof(u32));
+		if(!mp->units || !mp->actives) {
+			ret = MPXTN_ENOMEM;
+			goto End;
+		}
+	}
+	if(mp->p_srv->delay_num) {
+		mp->delays = calloc(mp->p_srv->delay_num, sizeof(DELAY));
+		if(!mp->delays) {
+			ret = MPXTN_ENOMEM;
+			goto End;
+		}
+		memcpy(mp->delays, mp->p_srv->delays, mp->p_srv->delay_num * sizeof(DELAY));
+	}
+
+	if(!_prepare(mp)) {
+		ret = MPXTN_EPREPARE;
+		goto End;
+	}
+
+End:
+	if(err) *err = ret;
+
+	if(ret != MPXTN_NOERR) {
+		mpxtn_close(mp);
+		return NULL;
+	}
+
+	return mp;
+}
+
 MPXTN_API void mpxtn_close(MPXTN *mp)
 {
 	if(!mp) return;
-	service_free(&mp->srv);
+
+	if(mp->delays) {
+		for(u32 i = 0; i < mp->p_srv->delay_num; ++i) {
+			delay_free(&mp->delays[i]);
+		}
+		free(mp->delays);
+	}
+	free(mp->units);
+	free(mp->actives);
+
+	_free_snapshots(mp);
+
+	mpxtn_song_close(mp->p_song);
 	free(mp);
 }
 
@@ -193,9 +390,9 @@ MPXTN_API void mpxtn_close(MPXTN *mp)
 static bool _reset_voice_on(MPXTN *mp, UNIT *p_u, s32 idx)
 {
 	if(idx < 0) return false;
-	if((u32)idx >= mp->srv.woice_num) return false;
+	if((u32)idx >= mp->p_srv->woice_num) return false;
 
-	WOICE *p_w = &mp->srv.woices[idx];
+	WOICE *p_w = &mp->p_srv->woices[idx];
 	unit_set_woice(p_u, p_w);
 
 	for(u32 i = 0; i < p_w->size; ++i) {
@@ -205,9 +402,10 @@ static bool _reset_voice_on(MPXTN *mp, UNIT *p_u, s32 idx)
 		f64 ofs_freq = 0;
 
 		if(p_wi->beatfit) {
-			ofs_freq = p_wi->smp_num * mp->beat_tempo / (MPXTN_SPS * 60 * p_wi->tuning);
+			ofs_freq = p_wi->smp_num * mp->beat_tempo / (mp->p_srv->sps * 60 * p_wi->tuning);
 		} else {
 			ofs_freq = freq_get(EVENTDEFAULT_BASICKEY - p_wi->basic_key) * p_wi->tuning;
+			ofs_freq = ofs_freq * ((f64)p_wi->sps / mp->p_srv->sps);
 		}
 
 		unit_tone_reset_and_2prm(p_u, i, (s32)(p_wi->env_release / mp->smp_per_clk), ofs_freq);
@@ -220,17 +418,36 @@ static bool _reset_voice_on(MPXTN *mp, UNIT *p_u, s32 idx)
 static bool _init_unit_tone(MPXTN *mp)
 {
 	if(!mp) return false;
-	if(!mp->srv.valid) return false;
 
-	for(u32 i = 0; i < mp->srv.unit_num; ++i) {
-		UNIT *p_u = &mp->srv.units[i];
+	for(u32 i = 0; i < mp->p_srv->unit_num; ++i) {
+		UNIT *p_u = &mp->units[i];
 		unit_tone_init(p_u);
 		if(!_reset_voice_on(mp, p_u, 0)) return false;
+
+		p_u->culled     = true;
+		p_u->culled_smp = mp->smp_count;
 	}
+	mp->active_num = 0;
 
 	return true;
 }
 
+/* rebuild the active list from culled flags, after units are restored */
+static void _collect_actives(MPXTN *mp)
+{
+	mp->active_num = 0;
+	for(u32 i = 0; i < mp->p_srv->unit_num; ++i) {
+		if(!mp->units[i].culled) mp->actives[mp->active_num++] = i;
+	}
+}
+
+/* proceed the culled unit to the current sample at once */
+static void _catch_up(MPXTN *mp, UNIT *p_u)
+{
+	if(mp->smp_count > p_u->culled_smp) unit_tone_skip(p_u, mp->smp_count - p_u->culled_smp);
+	p_u->culled_smp = mp->smp_count;
+}
+
 inline static void _proc_event_on(MPXTN *mp, UNIT *p_u, const EVERECORD *p_eve)
 {
 
@@ -259,12 +476,9 @@ inline static void _proc_event_on(MPXTN *mp, UNIT *p_u, const EVERECORD *p_eve)
 
 			s32 c = (s32)(p_eve->value + p_eve->clock + p_ut->env_release_clock);
 
-			EVERECORD* next = NULL;
-			for(EVERECORD* p = p_eve->next; p; p = p->next)
-			{
-				if(p->clock > c) break;
-				if(p->unit_no == p_eve->unit_no && p->kind == EVENTKIND_ON){ next = p; break; }
-			}
+			/* events are sorted by clock */
+			const EVERECORD* next = p_eve->next_on;
+			if(next && next->clock > c) next = NULL;
 			if(!next) max_life_count2 = (s32)(mp->smp_end) - (s32)(mp->clock * mp->smp_per_clk);
 			else      max_life_count2 = (s32)((next->clock - mp->clock) * mp->smp_per_clk);
 
@@ -291,7 +505,9 @@ inline static void _proc_event_on(MPXTN *mp, UNIT *p_u, const EVERECORD *p_eve)
 
 inline static void _proc_event(MPXTN *mp, const EVERECORD *p_eve)
 {
-	UNIT *p_u = &mp->srv.units[p_eve->unit_no];
+	UNIT *p_u = &mp->units[p_eve->unit_no];
+
+	if(p_u->culled) _catch_up(mp, p_u);
 
 	switch(p_eve->kind) {
 	case EVENTKIND_ON        : _proc_event_on  (mp, p_u, p_eve);        break;
@@ -311,20 +527,42 @@ inline static void _proc_event(MPXTN *mp, const EVERECORD *p_eve)
 	case EVENTKIND_TUNING    : unit_tone_tuning   (p_u, *(const float*)(&p_eve->value)); break;
 	}
 
+	/* only ON event makes the unit sound */
+	if(p_u->culled && p_eve->kind == EVENTKIND_ON && !unit_tone_silent(p_u)) {
+		p_u->culled = false;
+		mp->actives[mp->active_num++] = p_eve->unit_no;
+	}
 }
 
-static bool _PXTONE_SAMPLE(MPXTN *mp)
+/* first sample which reaches the clock, limited to smp_limit */
+static u32 _clock_to_smp(const MPXTN *mp, s32 clock, u32 smp_limit)
+{
+	u32 smp  = smp_limit;
+	f64 work = clock * mp->smp_per_clk;
+
+	if(work < smp_limit) smp = (u32)work;
+	if(smp < mp->smp_count) smp = mp->smp_count;
+
+	/* adjust error of float calc, same as clock calc in _PXTONE_BLOCK */
+	while(smp < smp_limit && (s32)(smp / mp->smp_per_clk) < clock) smp++;
+	while(smp > mp->smp_count && (s32)((smp - 1) / mp->smp_per_clk) >= clock) smp--;
+
+	return smp;
+}
+
+static bool _PXTONE_BLOCK(MPXTN *mp, u32 *p_num)
 {
 	u32 i;
-	u32 ch;
-	s32 work;
+	u32 g;
+	u32 smp_num;
+	u32 smp_limit;
 
 	/* get current clock */
 	mp->clock = (s32)(mp->smp_count / mp->smp_per_clk);
 
-	/* envelope.. */
-	for(i = 0; i < mp->srv.unit_num; ++i) {
-		unit_tone_envelope(&mp->srv.units[i]);
+	/* envelope.. culled units have no alive tone */
+	for(i = 0; i < mp->active_num; ++i) {
+		unit_tone_envelope(&mp->units[mp->actives[i]]);
 	}
 
 	/* proc events within target sample clock */
@@ -333,56 +571,76 @@ static bool _PXTONE_SAMPLE(MPXTN *mp)
 		mp->p_eve = mp->p_eve->next;
 	}
 
-	/* sampling */
-	for(i = 0; i < mp->srv.unit_num; ++i) {
-		unit_tone_sample(&mp->srv.units[i], mp->time_pan_idx, mp->smp_smooth);
-	}
-
-	for(ch = 0; ch < MPXTN_CH; ++ch) {
+	/* block size: until next event or end of samples */
+	smp_limit = UINT32_MAX;
+	if(*p_num < UINT32_MAX - mp->smp_count) smp_limit = mp->smp_count + *p_num;
+	if(mp->smp_end > mp->smp_count && smp_limit > mp->smp_end) smp_limit = mp->smp_end;
+	if(mp->p_eve) smp_limit = _clock_to_smp(mp, mp->p_eve->clock, smp_limit);
 
-		/* clear */
-		work = 0;
-		for(i = 0; i < GROUP_MAX; ++i) mp->group_smps[i] = 0;
+	smp_num = smp_limit - mp->smp_count;
+	if(smp_num == 0)              smp_num = 1;
 
-		for(i = 0; i < mp->srv.unit_num; ++i) {
-			unit_tone_supple(&mp->srv.units[i], mp->group_smps, ch, mp->time_pan_idx);
-		}
+	/* silent: jump to the next event */
+	mp->silent = (mp->active_num == 0);
+	for(i = 0; i < mp->p_srv->delay_num && mp->silent; ++i) {
+		if(!delay_tone_drained(&mp->delays[i])) mp->silent = false;
+	}
 
-		/* effect */
-		for(i = 0; i < mp->srv.ovdrv_num; ++i) {
-			overdrive_tone_supple(&mp->srv.ovdrvs[i], mp->group_smps);
+	if(mp->silent) {
+		for(i = 0; i < mp->p_srv->delay_num; ++i) {
+			delay_tone_skip(&mp->delays[i], smp_num);
 		}
+		goto Increment;
+	}
 
-		for(i = 0; i < mp->srv.delay_num; ++i) {
-			delay_tone_supple(&mp->srv.delays[i], mp->group_smps, ch);
-		}
+	if(smp_num > BUFSIZE_RENDER)  smp_num = BUFSIZE_RENDER;
 
-		/* collect */
-		for(i = 0; i < GROUP_MAX; ++i) work += mp->group_smps[i];
+	/* clear */
+	for(g = 0; g < GROUP_MAX; ++g) {
+		memset(mp->group_bufs[g], 0, smp_num * MPXTN_CH * sizeof(s32));
+	}
 
-		if(work >   mp->top) work =   mp->top;
-		if(work < - mp->top) work = - mp->top;
+	/* sampling, cull units which become silent */
+	for(i = 0; i < mp->active_num; ) {
+		UNIT *p_u = &mp->units[mp->actives[i]];
+		unit_tone_render(p_u, mp->group_bufs[p_u->groupno], mp->time_pan_idx, mp->smp_smooth, mp->interp, smp_num);
 
-		/* to buffer */
-		mp->smp_data[ch] = (s16)work;
+		if(unit_tone_silent(p_u)) {
+			p_u->culled     = true;
+			p_u->culled_smp = mp->smp_count + smp_num;
+			mp->actives[i]  = mp->actives[--mp->active_num];
+		} else {
+			i++;
+		}
 	}
 
-	/* increment */
-	mp->smp_count++;
-	mp->time_pan_idx = (mp->time_pan_idx + 1) & (BUFSIZE_TIMEPAN - 1);
+	/* effect */
+	for(i = 0; i < mp->p_srv->ovdrv_num; ++i) {
+		OVERDRIVE *p_o = &mp->p_srv->ovdrvs[i];
+		if(mp->discard && !(mp->delay_groups & (1u << p_o->group))) continue;
+		overdrive_tone_supple(p_o, mp->group_bufs[p_o->group], smp_num);
+	}
 
-	/* Units */
-	for(i = 0; i < mp->srv.unit_num; ++i) {
-		UNIT *p_u = &mp->srv.units[i];
-		s32 key = unit_tone_increment_key(p_u);
-		unit_tone_increment_sample(p_u, freq_get2(key));
+	for(i = 0; i < mp->p_srv->delay_num; ++i) {
+		DELAY *p_d = &mp->delays[i];
+		delay_tone_supple(p_d, mp->group_bufs[p_d->group], smp_num);
 	}
 
-	/* Delays */
-	for(i = 0; i < mp->srv.delay_num; ++i) {
-		delay_tone_increment(&mp->srv.delays[i]);
+	if(mp->discard) goto Increment;
+
+	/* collect */
+	for(i = 0; i < smp_num * MPXTN_CH; ++i) {
+		s32 work = 0;
+		for(g = 0; g < GROUP_MAX; ++g) work += mp->group_bufs[g][i];
+		mp->mix_buf[i] = work;
 	}
 
+Increment:
+	mp->smp_count += smp_num;
+	mp->time_pan_idx = (mp->time_pan_idx + smp_num) & (BUFSIZE_TIMEPAN - 1);
+
+	*p_num = smp_num;
+
 	/* TODO: fade in/out */
 
 	/* end of samples */
@@ -392,7 +650,7 @@ static bool _PXTONE_SAMPLE(MPXTN *mp)
 
 		/* prepare from repeat point */
 		mp->smp_count = mp->smp_repeat;
-		mp->p_eve     = evelist_get_records(&mp->srv.evels);
+		mp->p_eve     = evelist_get_records(&mp->p_srv->evels);
 		if(!_init_unit_tone(mp)) return false;
 	}
 
@@ -400,61 +658,123 @@ static bool _PXTONE_SAMPLE(MPXTN *mp)
 }
 
 
-MPXTN_API size_t mpxtn_vomit(void* buffer, size_t count, MPXTN* mp)
+static void _vomit_s16(s16 *p_dst, const s32 *p_src, u32 size, s32 top)
+{
+	for(u32 i = 0; i < size; ++i) {
+		s32 work = p_src[i];
+
+		if(work >   top) work =   top;
+		if(work < - top) work = - top;
+
+		p_dst[i] = (s16)work;
+	}
+}
+
+static void _vomit_f32(f32 *p_dst, const s32 *p_src, u32 size)
+{
+	for(u32 i = 0; i < size; ++i) {
+		p_dst[i] = (f32)p_src[i] * (1.0f / (INT16_MAX + 1));
+	}
+}
+
+/* buffers: [0] is used except _VOMIT_GROUPS, NULL buffer is skipped */
+static size_t _vomit(MPXTN* mp, void** buffers, u32 buffer_num, size_t count, _VOMITTYPE type)
 {
 	size_t i = 0;
-	size_t vomited = 0;
-	s16 *dst = (s16*)buffer;
+	size_t smp_size = 0;
 
-	if(!buffer)        return 0;
+	if(!buffers)       return 0;
+	if(!buffer_num)    return 0;
 	if(!count)         return 0;
 	if(!mp)            return 0;
-	if(!mp->srv.valid) return 0;
 	if(mp->end_vomit)  return 0;
 
+	switch(type)
+	{
+	case _VOMIT_S16:    smp_size = sizeof(s16) * MPXTN_CH; buffer_num = 1; break;
+	case _VOMIT_S32:    smp_size = sizeof(s32) * MPXTN_CH; buffer_num = 1; break;
+	case _VOMIT_F32:    smp_size = sizeof(f32) * MPXTN_CH; buffer_num = 1; break;
+	case _VOMIT_GROUPS: smp_size = sizeof(f32) * MPXTN_CH;                 break;
+	}
+
+	if(buffer_num > GROUP_MAX) buffer_num = GROUP_MAX;
+
 	while(i < count && !mp->end_vomit) {
-		if(!_PXTONE_SAMPLE(mp)) {
-			mp->end_vomit = true;
-			*(dst++) = mp->smp_data[0];
-			*(dst++) = mp->smp_data[1];
-			i++;
-			break;
+
+		u32 num = UINT32_MAX;
+		if(count - i < num) num = (u32)(count - i);
+
+		if(!_PXTONE_BLOCK(mp, &num)) mp->end_vomit = true;
+
+		for(u32 b = 0; b < buffer_num; ++b) {
+
+			if(!buffers[b]) continue;
+
+			void *dst = (u8*)buffers[b] + i * smp_size;
+
+			if(mp->silent) {
+				memset(dst, 0, num * smp_size);
+				continue;
+			}
+
+			switch(type)
+			{
+			case _VOMIT_S16:    _vomit_s16(dst, mp->mix_buf, num * MPXTN_CH, mp->top); break;
+			case _VOMIT_S32:    memcpy(dst, mp->mix_buf, num * smp_size);              break;
+			case _VOMIT_F32:    _vomit_f32(dst, mp->mix_buf, num * MPXTN_CH);          break;
+			case _VOMIT_GROUPS: _vomit_f32(dst, mp->group_bufs[b], num * MPXTN_CH);    break;
+			}
 		}
-		*(dst++) = mp->smp_data[0];
-		*(dst++) = mp->smp_data[1];
-		i++;
+
+		i += num;
 	}
-	vomited = i;
 
-	while(i < count) {
-		*(dst++) = 0;
-		*(dst++) = 0;
-		i++;
+	/* zero fill (0.0f is also all bits zero) */
+	for(u32 b = 0; b < buffer_num && i < count; ++b) {
+		if(buffers[b]) memset((u8*)buffers[b] + i * smp_size, 0, (count - i) * smp_size);
 	}
 
-	return vomited;
+	return i;
 }
 
-MPXTN_API bool mpxtn_reset(MPXTN *mp)
+MPXTN_API size_t mpxtn_vomit(void* buffer, size_t count, MPXTN* mp)
 {
-	if(!mp) return false;
-	if(!mp->srv.valid) return false;
+	return _vomit(mp, &buffer, 1, count, _VOMIT_S16);
+}
 
+MPXTN_API size_t mpxtn_vomit_s32(void* buffer, size_t count, MPXTN* mp)
+{
+	return _vomit(mp, &buffer, 1, count, _VOMIT_S32);
+}
+
+MPXTN_API size_t mpxtn_vomit_f32(void* buffer, size_t count, MPXTN* mp)
+{
+	return _vomit(mp, &buffer, 1, count, _VOMIT_F32);
+}
+
+MPXTN_API size_t mpxtn_vomit_groups(void** buffers, size_t group_num, size_t count, MPXTN* mp)
+{
+	if(group_num > GROUP_MAX) group_num = GROUP_MAX;
+	return _vomit(mp, buffers, (u32)group_num, count, _VOMIT_GROUPS);
+}
+
+/* clear tones and rewind event cursor */
+static bool _rewind(MPXTN *mp)
+{
 	mp->end_vomit = false;
-	mp->loop = false;
 
 	mp->time_pan_idx = 0;
 
 	mp->smp_count  = 0;
 
-	mp->p_eve = evelist_get_records(&mp->srv.evels);
+	mp->p_eve = evelist_get_records(&mp->p_srv->evels);
 
 	/* clear tones */
-	for(u32 i = 0; i < mp->srv.delay_num; ++i) {
-		delay_tone_clear(&mp->srv.delays[i]);
+	for(u32 i = 0; i < mp->p_srv->delay_num; ++i) {
+		delay_tone_clear(&mp->delays[i]);
 	}
-	for(u32 i = 0; i < mp->srv.unit_num; ++i) {
-		unit_tone_clear(&mp->srv.units[i]);
+	for(u32 i = 0; i < mp->p_srv->unit_num; ++i) {
+		unit_tone_clear(&mp->units[i]);
 	}
 
 	if(!_init_unit_tone(mp)) return false;
@@ -462,11 +782,168 @@ MPXTN_API bool mpxtn_reset(MPXTN *mp)
 	return true;
 }
 
+/* render and discard until smp_num, smp_num must be less than smp_end */
+static void _skip(MPXTN *mp, u32 smp_num)
+{
+	mp->discard = true;
+	while(mp->smp_count < smp_num) {
+		u32 num = smp_num - mp->smp_count;
+		_PXTONE_BLOCK(mp, &num);
+	}
+	mp->discard = false;
+}
+
+MPXTN_API bool mpxtn_reset(MPXTN *mp)
+{
+	if(!mp) return false;
+
+	mp->loop = false;
+
+	return _rewind(mp);
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _free_snapshots(MPXTN *mp)
+{
+	for(u32 i = 0; i < mp->snap_num; ++i) {
+		_SNAPSHOT *p_s = &mp->snaps[i];
+		free(p_s->units);
+		free(p_s->delays);
+		free(p_s->delay_bufs);
+	}
+	free(mp->snaps);
+
+	mp->snaps    = NULL;
+	mp->snap_num = 0;
+}
+
+static bool _store_snapshot(MPXTN *mp, _SNAPSHOT *p_s)
+{
+	const SERVICE *p_srv = mp->p_srv;
+	size_t buf_size = 0;
+
+	/* drained buffers are all zero, not stored */
+	for(u32 i = 0; i < p_srv->delay_num; ++i) {
+		if(delay_tone_drained(&mp->delays[i])) continue;
+		buf_size += mp->delays[i].smp_num * MPXTN_CH;
+	}
+
+	p_s->smp_count    = mp->smp_count;
+	p_s->time_pan_idx = mp->time_pan_idx;
+	p_s->p_eve        = mp->p_eve;
+
+	if(p_srv->unit_num) {
+		p_s->units = malloc(p_srv->unit_num * sizeof(UNIT));
+		if(!p_s->units) return false;
+		memcpy(p_s->units, mp->units, p_srv->unit_num * sizeof(UNIT));
+	}
+	if(p_srv->delay_num) {
+		p_s->delays = malloc(p_srv->delay_num * sizeof(DELAY));
+		if(!p_s->delays) return false;
+		memcpy(p_s->delays, mp->delays, p_srv->delay_num * sizeof(DELAY));
+	}
+	if(buf_size) {
+		p_s->delay_bufs = malloc(buf_size * sizeof(s32));
+		if(!p_s->delay_bufs) return false;
+	}
+
+	buf_size = 0;
+	for(u32 i = 0; i < p_srv->delay_num; ++i) {
+		const DELAY *p_d = &mp->delays[i];
+		if(!p_d->smp_num || delay_tone_drained(p_d)) continue;
+		memcpy(&p_s->delay_bufs[buf_size], p_d->p_buf, p_d->smp_num * MPXTN_CH * sizeof(s32));
+		buf_size += p_d->smp_num * MPXTN_CH;
+	}
+
+	return true;
+}
+
+static void _restore_snapshot(MPXTN *mp, const _SNAPSHOT *p_s)
+{
+	const SERVICE *p_srv = mp->p_srv;
+	size_t buf_size = 0;
+
+	mp->end_vomit    = false;
+	mp->smp_count    = p_s->smp_count;
+	mp->time_pan_idx = p_s->time_pan_idx;
+	mp->p_eve        = p_s->p_eve;
+
+	if(p_srv->unit_num) memcpy(mp->units, p_s->units, p_srv->unit_num * sizeof(UNIT));
+	_collect_actives(mp);
+
+	for(u32 i = 0; i < p_srv->delay_num; ++i) {
+		DELAY *p_d = &mp->delays[i];
+		s32 *p_buf = p_d->p_buf;
+
+		*p_d = p_s->delays[i];
+		p_d->p_buf = p_buf;
+
+		if(!p_d->smp_num) continue;
+		if(delay_tone_drained(p_d)) {
+			delay_tone_clear(p_d);
+			continue;
+		}
+		memcpy(p_d->p_buf, &p_s->delay_bufs[buf_size], p_d->smp_num * MPXTN_CH * sizeof(s32));
+		buf_size += p_d->smp_num * MPXTN_CH;
+	}
+}
+
+MPXTN_API bool mpxtn_build_seek_index(MPXTN *mp, unsigned int meas_interval)
+{
+	bool ret = false;
+	bool loop;
+	u32 num;
+
+	if(!mp) return false;
+
+	_free_snapshots(mp);
+
+	if(!meas_interval) return true;
+
+	/* snapshot at every meas_interval from the top */
+	num = (mp->meas_end + meas_interval - 1) / meas_interval;
+	if(!num) return true;
+
+	mp->snaps = calloc(num, sizeof(_SNAPSHOT));
+	if(!mp->snaps) return false;
+	mp->snap_num = num;
+
+	/* pre-pass, play through without loop */
+	loop = mp->loop;
+	mp->loop = false;
+
+	if(!_rewind(mp)) goto End;
+
+	for(u32 i = 0; i < num; ++i) {
+		s32 clock = (s32)(i * meas_interval * mp->beat_num * mp->beat_clock);
+		u32 smp   = _clock_to_smp(mp, clock, mp->smp_end);
+
+		if(smp >= mp->smp_end) {
+			mp->snap_num = i;
+			break;
+		}
+
+		_skip(mp, smp);
+
+		if(!_store_snapshot(mp, &mp->snaps[i])) goto End;
+	}
+
+	if(!_rewind(mp)) goto End;
+
+	ret = true;
+End:
+	mp->loop = loop;
+
+	if(!ret) _free_snapshots(mp);
+
+	return ret;
+}
+
 MPXTN_API bool mpxtn_seek(MPXTN *mp, size_t _smp_num)
 {
 
 	if(!mp) return false;
-	if(!mp->srv.valid) return false;
 	if(_smp_num > UINT32_MAX) return false;
 
 	u32 smp_num = (u32)_smp_num;
@@ -478,36 +955,43 @@ MPXTN_API bool mpxtn_seek(MPXTN *mp, size_t _smp_num)
 		return true;
 	}
 
-	if(smp_num >= mp->smp_count) {
-		/* seek forward */
-		mp->smp_count = smp_num;
-	} else {
-		/* seek backward */
-		mp->end_vomit = false;
+	if(mp->snap_num) {
+		/* restore nearest snapshot and render to the target */
+		u32 lo = 0, hi = mp->snap_num;
+		while(hi - lo > 1) {
+			u32 mid = (lo + hi) / 2;
+			if(mp->snaps[mid].smp_count <= smp_num) lo = mid;
+			else                                    hi = mid;
+		}
 
-		mp->time_pan_idx = 0;
+		/* continue from current position if it is nearer */
+		if(mp->end_vomit || smp_num < mp->smp_count || mp->snaps[lo].smp_count > mp->smp_count) {
+			_restore_snapshot(mp, &mp->snaps[lo]);
+		}
 
-		mp->smp_count  = smp_num;
+		_skip(mp, smp_num);
+		return true;
+	}
 
-		mp->p_eve = evelist_get_records(&mp->srv.evels);
+	if(smp_num < mp->smp_count) {
+		/* seek backward */
+		if(!_rewind(mp)) return false;
+	}
 
-		/* clear tones */
-		for(u32 i = 0; i < mp->srv.delay_num; ++i) {
-			delay_tone_clear(&mp->srv.delays[i]);
-		}
-		for(u32 i = 0; i < mp->srv.unit_num; ++i) {
-			unit_tone_clear(&mp->srv.units[i]);
-		}
+	mp->end_vomit = false;
+	mp->smp_count = smp_num;
 
-		if(!_init_unit_tone(mp)) return false;
+	/* no render while jumping */
+	for(u32 i = 0; i < mp->p_srv->unit_num; ++i) {
+		mp->units[i].culled_smp = smp_num;
+	}
 
-		mp->clock = (s32)(mp->smp_count / mp->smp_per_clk);
+	mp->clock = (s32)(mp->smp_count / mp->smp_per_clk);
 
-		/* proc events within target sample clock */
-		while(mp->p_eve && mp->p_eve->clock <= mp->clock) {
-			_proc_event(mp, mp->p_eve);
-			mp->p_eve = mp->p_eve->next;
-		}
+	/* proc events within target sample clock */
+	while(mp->p_eve && mp->p_eve->clock <= mp->clock) {
+		_proc_event(mp, mp->p_eve);
+		mp->p_eve = mp->p_eve->next;
 	}
 
 	return true;
@@ -516,7 +1000,6 @@ MPXTN_API bool mpxtn_seek(MPXTN *mp, size_t _smp_num)
 MPXTN_API size_t mpxtn_get_total_samples(const MPXTN *mp)
 {
 	if(!mp) return 0;
-	if(!mp->srv.valid) return 0;
 
 	return mp->smp_end;
 }
@@ -524,7 +1007,6 @@ MPXTN_API size_t mpxtn_get_total_samples(const MPXTN *mp)
 MPXTN_API size_t mpxtn_get_current_sample(const MPXTN *mp)
 {
 	if(!mp) return 0;
-	if(!mp->srv.valid) return 0;
 
 	return mp->smp_count;
 }
@@ -532,15 +1014,30 @@ MPXTN_API size_t mpxtn_get_current_sample(const MPXTN *mp)
 MPXTN_API size_t mpxtn_get_repeat_sample(const MPXTN *mp)
 {
 	if(!mp) return 0;
-	if(!mp->srv.valid) return 0;
 
 	return mp->smp_repeat;
 }
 
+MPXTN_API unsigned int mpxtn_get_sps(const MPXTN *mp)
+{
+	if(!mp) return 0;
+
+	return mp->p_srv->sps;
+}
+
+MPXTN_API bool mpxtn_set_interpolation(MPXTN *mp, int interp)
+{
+	if(!mp) return false;
+	if(interp < 0 || interp >= INTERP_NUM) return false;
+
+	mp->interp = (u8)interp;
+
+	return true;
+}
+
 MPXTN_API bool mpxtn_get_loop(const MPXTN *mp)
 {
 	if(!mp) return 0;
-	if(!mp->srv.valid) return 0;
 
 	return mp->loop;
 }
@@ -548,7 +1045,7 @@ MPXTN_API bool mpxtn_get_loop(const MPXTN *mp)
 MPXTN_API void mpxtn_set_loop(MPXTN *mp, bool loop)
 {
 	if(!mp) return;
-	if(!mp->srv.valid) return;
+	if(!mp->p_srv->valid) return;
 
 	mp->loop = loop;
 }
@@ -58,15 +58,68 @@ extern "C"
 #define MPXTN_API
 #endif
 
+#define MPXTN_GROUP_MAX 7
+
 struct _MPXTN;
 typedef struct _MPXTN MPXTN;
 
+struct _MPXTN_SONG;
+typedef struct _MPXTN_SONG MPXTN_SONG;
+
+typedef struct {
+	unsigned int sps; /* output sample rate (8000 - 192000), 0: 44100 */
+	bool lazy_woice;  /* decode only woices which events refer */
+	unsigned int woice_threads; /* woice decode threads, 0: single */
+	int resample;     /* MPXTN_RESAMPLE_*, PCM/OGG woices to sps */
+	unsigned int ptv_scale; /* PTV wave length is 400 x ptv_scale (1 - 64), 0: 1 */
+	bool ptv_mipmap;  /* band-limited PTV waves for high keys */
+	unsigned int ptn_threads; /* threads to build noise units of a PTN woice, 0: single */
+} MPXTN_OPTION;
+
+#define MPXTN_RESAMPLE_NEAREST 0 /* default, as pxtone */
+#define MPXTN_RESAMPLE_LOW     1 /* 16 taps windowed sinc */
+#define MPXTN_RESAMPLE_HIGH    2 /* 64 taps windowed sinc */
+
 MPXTN_API MPXTN *mpxtn_fread(FILE* fp, int* err);
 MPXTN_API MPXTN *mpxtn_mread(const void* p, size_t size, int* err);
 
+/* opt: NULL is same as mpxtn_fread/mpxtn_mread */
+MPXTN_API MPXTN *mpxtn_fread_opt(FILE* fp, const MPXTN_OPTION* opt, int* err);
+MPXTN_API MPXTN *mpxtn_mread_opt(const void* p, size_t size, const MPXTN_OPTION* opt, int* err);
+
+/* NOTE: MPXTN_SONG holds woices/events and is read only,
+ *       so many players (MPXTN) can render from one song concurrently.
+ *       players keep a reference, the song may be closed before them. */
+MPXTN_API MPXTN_SONG *mpxtn_song_fread(FILE* fp, const MPXTN_OPTION* opt, int* err);
+MPXTN_API MPXTN_SONG *mpxtn_song_mread(const void* p, size_t size, const MPXTN_OPTION* opt, int* err);
+MPXTN_API void mpxtn_song_close(MPXTN_SONG *song);
+
+MPXTN_API MPXTN *mpxtn_open(MPXTN_SONG *song, int* err);
+
+/* NOTE: process-wide cache of decoded woices, shared by songs which embed
+ *       the same material. budget: bytes, 0 disables (default).
+ *       least recently used entries are dropped over the budget.
+ *       the cache is locked, songs can be read in any thread. */
+MPXTN_API void mpxtn_set_woice_cache(size_t budget);
+
 /* NOTE: must alloc count * 4 byte memory */
 MPXTN_API size_t mpxtn_vomit(void* buffer, size_t count, MPXTN* mp);
 
+/* NOTE: must alloc count * 8 byte memory, not clipped */
+MPXTN_API size_t mpxtn_vomit_s32(void* buffer, size_t count, MPXTN* mp);
+
+/* NOTE: must alloc count * 8 byte memory, not clipped, 1.0f = 32768 */
+MPXTN_API size_t mpxtn_vomit_f32(void* buffer, size_t count, MPXTN* mp);
+
+/* NOTE: stems of each group after overdrive/delay, as mpxtn_vomit_f32.
+ *       buffers: up to MPXTN_GROUP_MAX, must alloc count * 8 byte memory each.
+ *       NULL buffer is skipped. */
+MPXTN_API size_t mpxtn_vomit_groups(void** buffers, size_t group_num, size_t count, MPXTN* mp);
+
+/* NOTE: capture playback state every meas_interval measures (0: disable),
+ *       then mpxtn_seek restores the nearest one and renders to the target.
+ *       this plays the whole song once, and rewinds to the top. */
+MPXTN_API bool mpxtn_build_seek_index(MPXTN *mp, unsigned int meas_interval);
 MPXTN_API bool mpxtn_seek(MPXTN *mp, size_t smp_num);
 
 MPXTN_API bool mpxtn_reset(MPXTN *mp);
@@ -74,6 +127,15 @@ MPXTN_API bool mpxtn_reset(MPXTN *mp);
 MPXTN_API size_t mpxtn_get_total_samples(const MPXTN *mp);
 MPXTN_API size_t mpxtn_get_current_sample(const MPXTN *mp);
 MPXTN_API size_t mpxtn_get_repeat_sample(const MPXTN *mp);
+MPXTN_API unsigned int mpxtn_get_sps(const MPXTN *mp);
+
+/* interpolation of woice playback */
+#define MPXTN_INTERP_NONE   0 /* nearest, default */
+#define MPXTN_INTERP_LINEAR 1
+#define MPXTN_INTERP_CUBIC  2 /* 4 points */
+#define MPXTN_INTERP_SINC   3 /* 8 points windowed sinc */
+
+MPXTN_API bool mpxtn_set_interpolation(MPXTN *mp, int interp);
 
 MPXTN_API void mpxtn_set_loop(MPXTN *mp, bool loop);
 MPXTN_API bool mpxtn_get_loop(const MPXTN *mp);
@@ -29,48 +29,72 @@
 
 const static f64 _pi = 3.1415926535897932;
 
-f64 oscillator_get_sample_overtone(OSCILLATOR *p_osci, s32 idx)
+bool oscillator_get_samples_overtone(OSCILLATOR *p_osci, f64 *p_smps)
 {
-	f64 work = 0;
-	f64 sss = 0;
+	s32 smp_num = p_osci->smp_num;
+	f64 *p_sin = NULL;
+
+	if(smp_num <= 0) return false;
+
+	/* harmonics are integer, sin(2pi * x * idx / smp_num) is one cycle table */
+	p_sin = malloc(sizeof(f64) * (size_t)smp_num);
+	if(!p_sin) return false;
+
+	for(s32 k = 0; k < smp_num; ++k) {
+		p_sin[k] = sin(2.0 * _pi * k / smp_num);
+		p_smps[k] = 0;
+	}
 
 	for(s32 i = 0; i < p_osci->point_num; ++i) {
 		const POINT *p = &p_osci->points[i];
-		sss = 2.0 * _pi * p->x * idx / p_osci->smp_num;
-		work += sin(sss) * p->y / p->x / 128.0;
+		s32 step = (s32)(p->x % smp_num);
+		s32 k = 0;
+
+		if(step < 0) step += smp_num;
+
+		for(s32 idx = 0; idx < smp_num; ++idx) {
+			p_smps[idx] += p_sin[k] * p->y / p->x / 128.0;
+			k += step;
+			if(k >= smp_num) k -= smp_num;
+		}
 	}
 
-	work = work * p_osci->volume / 128.0;
-	return work;
+	for(s32 idx = 0; idx < smp_num; ++idx) {
+		p_smps[idx] = p_smps[idx] * p_osci->volume / 128.0;
+	}
 
+	free(p_sin);
+	return true;
 }
 
-f64 oscillator_get_sample_coodinate(OSCILLATOR *p_osci, s32 idx)
+bool oscillator_get_samples_coodinate(OSCILLATOR *p_osci, f64 *p_smps)
 {
-	s32 i;
 	s32 x1, y1, x2, y2;
-	s32 w, h;
-	s32 c;
-	f64 work;
+	s32 c = 0;
 
-	i = p_osci->point_reso * idx / p_osci->smp_num;
+	if(p_osci->smp_num <= 0) return false;
 
-	// find target 2 ponits
-	for(c = 0; c < p_osci->point_num; ++c) {
-		if(p_osci->points[c].x > i) break;
+	/* no point, silent */
+	if(p_osci->point_num <= 0) {
+		for(s32 idx = 0; idx < p_osci->smp_num; ++idx) p_smps[idx] = 0;
+		return true;
 	}
 
-	/* end */
-	if(c == p_osci->point_num)
-	{
-		x1 = p_osci->points[c - 1].x;
-		y1 = p_osci->points[c - 1].y;
-		x2 = p_osci->point_reso;
-		y2 = p_osci->points[0].y;
-	}
-	else
-	{
-		if(c){
+	for(s32 idx = 0; idx < p_osci->smp_num; ++idx) {
+
+		s32 i = (s32)((s64)p_osci->point_reso * idx / p_osci->smp_num);
+		f64 work;
+
+		/* find target 2 points, i never decreases */
+		while(c < p_osci->point_num && p_osci->points[c].x <= i) c++;
+
+		/* end */
+		if(c == p_osci->point_num) {
+			x1 = p_osci->points[c - 1].x;
+			y1 = p_osci->points[c - 1].y;
+			x2 = p_osci->point_reso;
+			y2 = p_osci->points[0].y;
+		} else if(c) {
 			x1 = p_osci->points[c - 1].x;
 			y1 = p_osci->points[c - 1].y;
 			x2 = p_osci->points[c].x;
@@ -81,15 +105,14 @@ f64 oscillator_get_sample_coodinate(OSCILLATOR *p_osci, s32 idx)
 			x2 = p_osci->points[0].x;
 			y2 = p_osci->points[0].y;
 		}
-	}
 
-	w = x2 - x1;
-	i =  i - x1;
-	h = y2 - y1;
+		i -= x1;
 
-	if(i) work = y1 + (f64)h * i / w;
-	else  work = y1;
+		if(i) work = y1 + (f64)(y2 - y1) * i / (x2 - x1);
+		else  work = y1;
 
-	return work * p_osci->volume / 128.0 / 128.0;
-}
+		p_smps[idx] = work * p_osci->volume / 128.0 / 128.0;
+	}
 
+	return true;
+}
@@ -38,7 +38,8 @@ typedef struct {
 	POINT *points;
 } OSCILLATOR;
 
-f64 oscillator_get_sample_overtone(OSCILLATOR *p_osci, s32 idx);
-f64 oscillator_get_sample_coodinate(OSCILLATOR *p_osci, s32 idx);
+/* all smp_num samples at once to p_smps */
+bool oscillator_get_samples_overtone(OSCILLATOR *p_osci, f64 *p_smps);
+bool oscillator_get_samples_coodinate(OSCILLATOR *p_osci, f64 *p_smps);
 
 #endif
@@ -27,13 +27,15 @@
  * -------------------------------------------------------------------------- */
 #include "overdrive.h"
 
-void overdrive_tone_supple(OVERDRIVE *p_ovdrv, s32 *group_smps)
+void overdrive_tone_supple(OVERDRIVE *p_ovdrv, s32 *p_group, u32 smp_num)
 {
 	if(!p_ovdrv->played) return;
-	s32 a = group_smps[p_ovdrv->group];
-	if(a >  p_ovdrv->cut) a =  p_ovdrv->cut;
-	if(a < -p_ovdrv->cut) a = -p_ovdrv->cut;
-	group_smps[p_ovdrv->group] = a * p_ovdrv->amp; /* TODO: float calc -> int calc */
+	for(u32 i = 0; i < smp_num * MPXTN_CH; ++i) {
+		s32 a = p_group[i];
+		if(a >  p_ovdrv->cut) a =  p_ovdrv->cut;
+		if(a < -p_ovdrv->cut) a = -p_ovdrv->cut;
+		p_group[i] = a * p_ovdrv->amp; /* TODO: float calc -> int calc */
+	}
 }
 
 /* -------------------------------------------------------------------------- */
@@ -41,6 +41,6 @@ typedef struct {
 
 bool overdrive_read(OVERDRIVE *p_ovdrv, DESCRIPTOR *p_desc);
 
-void overdrive_tone_supple(OVERDRIVE *p_ovdrv, s32 *group_smps);
+void overdrive_tone_supple(OVERDRIVE *p_ovdrv, s32 *p_group, u32 smp_num);
 
 #endif
@@ -25,6 +25,15 @@
  * THE SOFTWARE.
  *
  * -------------------------------------------------------------------------- */
+#include "common.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define _PCM_SSE2
+#endif
+
+#include "resample.h"
+
 #include "pcm.h"
 
 /* -------------------------------------------------------------------------- */
@@ -35,6 +44,7 @@ bool pcm_alloc(PCM *p_pcm, u32 smp_num)
 	if(p_pcm->smps) return false;
 
 	p_pcm->smps = calloc(smp_num * MPXTN_CH, sizeof(s16));
+	p_pcm->ch = MPXTN_CH;
 	return p_pcm->smps != NULL;
 }
 
@@ -47,91 +57,84 @@ void pcm_free(PCM *p_pcm)
 	p_pcm->smps = NULL;
 }
 
+/* -------------------------------------------------------------------------- */
+static inline bool _is_little_endian(void)
+{
+	const u16 v = 1;
+	return *(const u8*)&v == 1;
+}
+
+/* unsigned 8bit -> s16 */
+static void _u8_to_s16(s16 *p_dst, const u8 *p_src, u32 num)
+{
+	u32 i = 0;
+
+#ifdef _PCM_SSE2
+	const __m128i sign = _mm_set1_epi8((char)0x80);
+	const __m128i zero = _mm_setzero_si128();
+
+	for(; i + 16 <= num; i += 16) {
+		/* (x - 128) << 8, signed byte to the high byte */
+		__m128i x = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(p_src + i)), sign);
+		_mm_storeu_si128((__m128i*)(p_dst + i    ), _mm_unpacklo_epi8(zero, x));
+		_mm_storeu_si128((__m128i*)(p_dst + i + 8), _mm_unpackhi_epi8(zero, x));
+	}
+#endif
+	for(; i < num; ++i) p_dst[i] = (s16)((p_src[i] - 128) * 0x100);
+}
+
+/* little endian 16bit -> s16 */
+static void _s16le_to_s16(s16 *p_dst, const u8 *p_src, u32 num)
+{
+	if(_is_little_endian()) {
+		memcpy(p_dst, p_src, num * sizeof(s16));
+		return;
+	}
+
+	for(u32 i = 0; i < num; ++i) {
+		u16 temp = (u16)(p_src[i * 2] | ((u16)p_src[i * 2 + 1] << 8));
+		p_dst[i] = (s16)temp;
+	}
+}
+
 /* -----------------------------------------------------------------------------
- * NOTE: if MPXTN_CH change to 1 from 2, this function not work correctly.
+ * NOTE: channels are kept, mono is not expanded to stereo.
  */
-static s16 *_adjust_ch_and_bps(const u8* p_buf, u32 size, u16 ch, u16 bps)
+static s16 *_adjust_bps(const u8* p_buf, u32 size, u16 ch, u16 bps)
 {
 	s16* p_work = NULL;
-	u32 smp_num = size / ch / (bps / 8);
+	u32 num = size / (bps / 8); /* samples of all channels */
 
 	if(!p_buf) return NULL;
+	if(bps != 8 && bps != 16) return NULL;
 
-	p_work = calloc(smp_num * MPXTN_CH, sizeof(s16));
+	p_work = malloc(num * sizeof(s16));
 	if(!p_work) return NULL;
 
-	if(ch == 1 && bps == 8) {
-		for(u32 i = 0; i < smp_num; ++i) {
-			s16 temp = p_buf[i];
-			temp = (temp - 128) * 0x100;
-
-			p_work[i * 2]     = temp;
-			p_work[i * 2 + 1] = temp;
-		}
-	} else if(ch == 1 && bps == 16) {
-		for(u32 i = 0; i < smp_num; ++i) {
-			/* read as little endian */
-			u16 temp;
-			temp  =       p_buf[i * 2];
-			temp |= ((u16)p_buf[i * 2 + 1] << 8);
-
-			p_work[i * 2]     = *(s16*)&temp;
-			p_work[i * 2 + 1] = *(s16*)&temp;
-		}
-	} else if(ch == 2 && bps == 8) {
-		for(u32 i = 0; i < smp_num * 2; ++i) {
-			s16 temp = p_buf[i];
-			temp = (temp - 128) * 0x100;
-
-			p_work[i] = temp;
-		}
-	} else if(ch == 2 && bps == 16) {
-		for(u32 i = 0; i < smp_num * 2; ++i) {
-			/* read as little endian */
-			u16 temp;
-			temp  =       p_buf[i * 2];
-			temp |= ((u16)p_buf[i * 2 + 1] << 8);
-
-			p_work[i] = *(s16*)&temp;
-		}
-	} else {
-		/* nothing to do */
-		free(p_work);
-		return NULL;
-	}
+	if(bps == 8) _u8_to_s16   (p_work, p_buf, num);
+	else         _s16le_to_s16(p_work, p_buf, num);
 
 	return p_work;
 }
 
-static bool _adjust_sps(s16** p_buf, u32 sps, u32 *smp_num)
+static bool _adjust_sps(s16** p_buf, u16 ch, u32 sps, u32 dst_sps, u32 *smp_num, u8 quality, bool loop)
 {
 	if(!p_buf) return false;
-	if(*smp_num == MPXTN_SPS) return true; /* nothing to do */
+	if(sps == dst_sps) return true; /* nothing to do */
 
-	s16* p_work = NULL;
-	u32 new_smp_num = (u32)(((f64)*smp_num * MPXTN_SPS + sps - 1) / sps);
-	p_work = calloc(new_smp_num * MPXTN_CH, sizeof(s16));
+	s16* p_work = resample(*p_buf, smp_num, ch, sps, dst_sps, quality, loop);
 	if(!p_work) return false;
 
-	f64 rate = (f64)sps / MPXTN_SPS;
-
-	u32 *p_src = (u32*)*p_buf;
-	u32 *p_dst = (u32*)p_work;
-	for(u32 i = 0; i < new_smp_num; ++i) {
-		u32 src_idx = (u32)(i * rate);
-		p_dst[i] = p_src[src_idx];
-	}
-
 	/* replace buffer */
 	free(*p_buf);
 	*p_buf = p_work;
-	*smp_num = new_smp_num;
 
 	return true;
 }
 
 /* -------------------------------------------------------------------------- */
-bool pcm_mem_read(PCM *p_pcm, const void *p, u32 size, u16 ch, u16 bps, u32 sps)
+static bool _mem_read(PCM *p_pcm, const void *p, void **pp_move, u32 size, u16 ch, u16 bps,
+                      u32 sps, u32 dst_sps, u8 quality, bool loop)
 {
 	if(!p_pcm) return false;
 	if(!p) return false;
@@ -140,15 +143,23 @@ bool pcm_mem_read(PCM *p_pcm, const void *p, u32 size, u16 ch, u16 bps, u32 sps)
 	if(ch  != 1 && ch  !=  2) return false;
 	if(bps != 8 && bps != 16) return false;
 	if(sps == 0) return false;
+	if(dst_sps == 0) return false;
 
 	pcm_free(p_pcm);
 
 	p_pcm->smp_num = size / ch / (bps / 8);
+	p_pcm->ch = ch;
 
-	p_pcm->smps = _adjust_ch_and_bps(p, size, ch, bps);
-	if(!p_pcm->smps) return false;
+	if(pp_move && bps == 16 && _is_little_endian()) {
+		/* zero copy, the source is already s16 */
+		p_pcm->smps = *pp_move;
+		*pp_move = NULL;
+	} else {
+		p_pcm->smps = _adjust_bps(p, p_pcm->smp_num * ch * (bps / 8), ch, bps);
+		if(!p_pcm->smps) return false;
+	}
 
-	if(!_adjust_sps(&p_pcm->smps, sps, &p_pcm->smp_num)) {
+	if(!_adjust_sps(&p_pcm->smps, ch, sps, dst_sps, &p_pcm->smp_num, quality, loop)) {
 		pcm_free(p_pcm);
 		return false;
 	}
@@ -156,3 +167,13 @@ bool pcm_mem_read(PCM *p_pcm, const void *p, u32 size, u16 ch, u16 bps, u32 sps)
 	return true;
 }
 
+bool pcm_mem_read(PCM *p_pcm, const void *p, u32 size, u16 ch, u16 bps, u32 sps, u32 dst_sps, u8 quality, bool loop)
+{
+	return _mem_read(p_pcm, p, NULL, size, ch, bps, sps, dst_sps, quality, loop);
+}
+
+bool pcm_mem_move(PCM *p_pcm, void **pp, u32 size, u16 ch, u16 bps, u32 sps, u32 dst_sps, u8 quality, bool loop)
+{
+	if(!pp) return false;
+	return _mem_read(p_pcm, *pp, pp, size, ch, bps, sps, dst_sps, quality, loop);
+}
@@ -35,11 +35,16 @@
 typedef struct {
 	s16 *smps;
 	u32 smp_num;
+	u16 ch;      /* channels of smps, 1 or MPXTN_CH */
 } PCM;
 
 bool pcm_alloc(PCM *p_pcm, u32 smp_num);
 void pcm_free(PCM *p_pcm);
 
-bool pcm_mem_read(PCM *p_pcm, const void *p, u32 size, u16 ch, u16 bps, u32 sps);
+/* quality: RESAMPLE_*, loop: wrap edges on resampling */
+bool pcm_mem_read(PCM *p_pcm, const void *p, u32 size, u16 ch, u16 bps, u32 sps, u32 dst_sps, u8 quality, bool loop);
+
+/* same as pcm_mem_read, but may take *pp (malloc'd) as samples, then *pp is NULL */
+bool pcm_mem_move(PCM *p_pcm, void **pp, u32 size, u16 ch, u16 bps, u32 sps, u32 dst_sps, u8 quality, bool loop);
 
 #endif
@@ -29,6 +29,12 @@
 #include "ptn.h"
 
 #include "freq.h"
+#include "thread.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define _PTN_SSE2
+#endif
 
 static const char _code[] = "PTNOISE-";
 static const u32  _ver    =  20120418; // 16 wave types.
@@ -39,6 +45,9 @@ static const u32  _ver    =  20120418; // 16 wave types.
 #define BASIC_SMPS           441
 #define BASIC_RANDSMPS     44100
 
+#define _BLOCK             256     // samples of one build pass
+#define _SEGMENT           16384   // samples of one parallel pass, multiple of _BLOCK
+
 #define EDITFLAG_ENVELOPE  0x00000004u
 #define EDITFLAG_PAN       0x00000008u
 #define EDITFLAG_OSC_MAIN  0x00000010u
@@ -123,7 +132,7 @@ void ptn_free(PTN *p_ptn)
 
 /* -------------------------------------------------------------------------- */
 
-static void _set_osc(_OSCILLATOR *p_dst, const NOISEDESIGN_OSCILLATOR *p_src)
+static void _set_osc(_OSCILLATOR *p_dst, const NOISEDESIGN_OSCILLATOR *p_src, u32 sps)
 {
 	switch(p_src->type)
 	{
@@ -132,7 +141,7 @@ static void _set_osc(_OSCILLATOR *p_dst, const NOISEDESIGN_OSCILLATOR *p_src)
 	default              : p_dst->rnd_type = _RANDOM_None; break;
 	}
 
-	p_dst->increment = (f64)p_src->freq / BASIC_FREQUENCY;
+	p_dst->increment = ((f64)MPXTN_SPS / sps) * ((f64)p_src->freq / BASIC_FREQUENCY);
 
 	// offset
 	if( p_dst->rnd_type != _RANDOM_None ) p_dst->offset = 0;
@@ -167,220 +176,414 @@ static void _inc_osc(_OSCILLATOR *p_o, f64 increment)
 	}
 }
 
-/* -------------------------------------------------------------------------- */
+/* value before reverse and volume, offset is never negative */
+static inline f64 _osc_raw(const _OSCILLATOR *p_o)
+{
+	switch(p_o->rnd_type)
+	{
+	case _RANDOM_None: return p_o->smps[(u32)p_o->offset];
+	case _RANDOM_Saw : return p_o->rnd_start + p_o->rnd_margin * p_o->offset / BASIC_SMPS;
+	case _RANDOM_Rect: return p_o->rnd_start;
+	}
+	return 0;
+}
 
-static void _ptn_fix(PTN *p_ptn)
+static void _osc_apply(const _OSCILLATOR *p_o, u32 num, f64 *p_dst)
 {
+	if(p_o->reverse) for(u32 s = 0; s < num; ++s) p_dst[s] *= -1;
+	for(u32 s = 0; s < num; ++s) p_dst[s] *= p_o->volume;
 }
 
-/* -------------------------------------------------------------------------- */
-s16 *ptn_build(PTN *p_ptn)
+/* num values of main and volu oscillators, reverse and volume are applied.
+ * the oscillators are stepped together, their phases are independent chains. */
+static void _osc_block(_UNIT *p_u, u32 num, f64 *p_mains, f64 *p_volus)
 {
-	u32  offset   = 0;
-	f64  work     = 0;
-	f64  vol      = 0;
-	f64  fre      = 0;
-	f64  store    = 0;
-	s32  byte4    = 0;
-	s16 *p        = NULL;
-	s16  *smps    = NULL;
-	_UNIT *units  = NULL;
+	_OSCILLATOR *p_main = &p_u->main;
+	_OSCILLATOR *p_freq = &p_u->freq;
+	_OSCILLATOR *p_volu = &p_u->volu;
 
-	if(!p_ptn) goto End;
-	if(!p_ptn->size) goto End;
-	if(!p_ptn->smp_num) goto End;
+	for(u32 s = 0; s < num; ++s) {
 
-	/* alloc */
-	units = calloc(p_ptn->size, sizeof(_UNIT));
-	if(!units) goto End;
-	smps = calloc(p_ptn->smp_num * MPXTN_CH, sizeof(s16));
-	if(!smps) goto End;
-	p = smps;
+		f64 fre = _osc_raw(p_freq);
 
-	_ptn_fix(p_ptn);
+		if(p_freq->rnd_type == _RANDOM_None) fre = (f64)KEY_TOP * fre / INT16_MAX;
+		if(p_freq->reverse) fre *= -1;
+		fre *= p_freq->volume;
 
-	/* DESIGNUNIT -> _UNIT */
-	for(u8 i = 0; i < p_ptn->size; ++i)
-	{
-		_UNIT *p_u = &units[i];
-		const NOISEDESIGN_UNIT *p_du = &p_ptn->units[i];
+		p_mains[s] = _osc_raw(p_main);
+		p_volus[s] = _osc_raw(p_volu);
 
-		p_u->enable = p_du->enable;
+		_inc_osc(p_main, p_main->increment * freq_get((u32)fre));
+		_inc_osc(p_freq, p_freq->increment);
+		_inc_osc(p_volu, p_volu->increment);
+	}
 
-		if(p_du->pan == 0) {
+	_osc_apply(p_main, num, p_mains);
+	_osc_apply(p_volu, num, p_volus);
+}
 
-			p_u->pan[0] = 1.0;
-			p_u->pan[1] = 1.0;
+/* skip breakpoints of no length, margin is for the current one */
+static void _env_next(_UNIT *p_u)
+{
+	while(p_u->env_index < p_u->env_num) {
 
-		} else if(p_du->pan < 0) {
+		p_u->env_mag_margin = p_u->envs[p_u->env_index].mag - p_u->env_mag_start;
+		if(p_u->envs[p_u->env_index].smp) break;
+		p_u->env_mag_start  = p_u->envs[p_u->env_index].mag;
+		p_u->env_index++;
+	}
+}
 
-			p_u->pan[0] = 1.0;
-			p_u->pan[1] = (100.0 + p_du->pan) / 100.0;
+/* envelope of num samples, ramps of each segment */
+static void _env_block(_UNIT *p_u, u32 num, f64 *p_dst)
+{
+	u32 s = 0;
 
-		} else {
+	while(s < num) {
 
-			p_u->pan[1] = 1.0;
-			p_u->pan[0] = (100.0 - p_du->pan) / 100.0;
+		if(p_u->env_index >= p_u->env_num) {
+			for(; s < num; ++s) p_dst[s] = p_u->env_mag_start;
+			break;
 		}
 
-		/* envelope */
-		p_u->envs = calloc(p_du->env_num, sizeof(_POINT));
-		if(!p_u->envs) goto End;
-		p_u->env_num = p_du->env_num;
+		u32 seg  = p_u->envs[p_u->env_index].smp;
+		u32 run  = seg - p_u->env_count;
+		f64 start  = p_u->env_mag_start;
+		f64 margin = p_u->env_mag_margin;
 
-		for(u32 e = 0; e < p_du->env_num; ++e) {
+		if(run > num - s) run = num - s;
 
-			p_u->envs[e].smp = (u32)MPXTN_SPS * (u32)p_du->envs[e].x / 1000;
-			p_u->envs[e].mag = p_du->envs[e].y / 100.0;
-		}
+		for(u32 k = 0; k < run; ++k) p_dst[s + k] = start + (margin * (p_u->env_count + k) / seg);
 
-		p_u->env_index      = 0;
-		p_u->env_mag_start  = 0;
-		p_u->env_mag_margin = 0;
-		p_u->env_count      = 0;
-		while(p_u->env_index < p_u->env_num) {
+		s += run;
+		p_u->env_count += run;
 
-			p_u->env_mag_margin = p_u->envs[p_u->env_index].mag - p_u->env_mag_start;
-			if(p_u->envs[p_u->env_index].smp) break;
-			p_u->env_mag_start = p_u->envs[p_u->env_index].mag;
+		if(p_u->env_count >= seg) {
+			p_u->env_count      = 0;
+			p_u->env_mag_start  = p_u->envs[p_u->env_index].mag;
+			p_u->env_mag_margin = 0;
 			p_u->env_index++;
+
+			_env_next(p_u);
 		}
+	}
+}
 
-		_set_osc(&p_u->main, &p_du->main);
-		_set_osc(&p_u->freq, &p_du->freq);
-		_set_osc(&p_u->volu, &p_du->volu);
+/* -------------------------------------------------------------------------- */
+
+static void _ptn_fix(PTN *p_ptn)
+{
+}
+
+/* DESIGNUNIT -> _UNIT */
+static bool _unit_init(_UNIT *p_u, const NOISEDESIGN_UNIT *p_du, u32 sps)
+{
+	p_u->enable = p_du->enable;
+
+	if(p_du->pan == 0) {
+
+		p_u->pan[0] = 1.0;
+		p_u->pan[1] = 1.0;
+
+	} else if(p_du->pan < 0) {
+
+		p_u->pan[0] = 1.0;
+		p_u->pan[1] = (100.0 + p_du->pan) / 100.0;
+
+	} else {
+
+		p_u->pan[1] = 1.0;
+		p_u->pan[0] = (100.0 - p_du->pan) / 100.0;
 	}
 
-	for(u32 s = 0; s < p_ptn->smp_num; ++s) {
+	/* envelope */
+	p_u->envs = calloc(p_du->env_num, sizeof(_POINT));
+	if(!p_u->envs) return false;
+	p_u->env_num = p_du->env_num;
 
-		for(u32 c = 0; c < MPXTN_CH; ++c) {
+	for(u32 e = 0; e < p_du->env_num; ++e) {
 
-			store = 0;
-
-			for(u8 i = 0; i < p_ptn->size; ++i) {
-
-				const _UNIT *p_u = &units[i];
-
-				if(!p_u->enable) continue;
-
-				// main
-				{
-				const _OSCILLATOR *p_o = &p_u->main;
-				switch(p_o->rnd_type)
-				{
-				case _RANDOM_None:
-					offset = (u32)p_o->offset;
-					work = p_o->smps[offset];
-					break;
-				case _RANDOM_Saw:
-					if(p_o->offset >= 0) work = p_o->rnd_start + p_o->rnd_margin * p_o->offset / BASIC_SMPS;
-					else                 work = 0;
-					break;
-				case _RANDOM_Rect:
-					if( p_o->offset >= 0 ) work = p_o->rnd_start;
-					else                 work = 0;
-					break;
-				}
-				if(p_o->reverse) work *= -1;
-				work *= p_o->volume;
-				}
+		p_u->envs[e].smp = sps * (u32)p_du->envs[e].x / 1000;
+		p_u->envs[e].mag = p_du->envs[e].y / 100.0;
+	}
 
-				// volu
-				{
-				const _OSCILLATOR *p_o = &p_u->volu;
-				switch(p_o->rnd_type)
-				{
-				case _RANDOM_None:
-					offset = (u32)p_o->offset;
-					vol    = p_o->smps[offset];
-					break;
-				case _RANDOM_Saw:
-					vol = p_o->rnd_start + p_o->rnd_margin * p_o->offset / BASIC_SMPS;
-					break;
-				case _RANDOM_Rect:
-					vol = p_o->rnd_start;
-					break;
-				}
-				if( p_o->reverse ) vol *= -1;
-				vol *= p_o->volume;
+	p_u->env_index      = 0;
+	p_u->env_mag_start  = 0;
+	p_u->env_mag_margin = 0;
+	p_u->env_count      = 0;
+	_env_next(p_u);
 
-				work = work * (vol + INT16_MAX) / (INT16_MAX * 2);
-				work = work * p_u->pan[c];
-				}
-				// envelope
-				if(p_u->env_index < p_u->env_num)
-					work *= p_u->env_mag_start + (p_u->env_mag_margin * p_u->env_count / p_u->envs[p_u->env_index].smp);
-				else
-					work *= p_u->env_mag_start;
-				store += work;
-			}
+	_set_osc(&p_u->main, &p_du->main, sps);
+	_set_osc(&p_u->freq, &p_du->freq, sps);
+	_set_osc(&p_u->volu, &p_du->volu, sps);
+
+	return true;
+}
 
-			byte4 = (s32)store;
+/* add num samples of the unit to p_dsts[MPXTN_CH][num].
+ * the mono signal is made once, then panned as (signal * pan) * envelope. */
+static void _unit_render(_UNIT *p_u, u32 num, f64 **p_dsts)
+{
+	f64 mains[_BLOCK];
+	f64 volus[_BLOCK];
+	f64 envs [_BLOCK];
+
+	_osc_block(p_u, num, mains, volus);
+	_env_block(p_u, num, envs);
+
+	f64 *p_l = p_dsts[0], *p_r = p_dsts[1];
+	f64 pan_l = p_u->pan[0], pan_r = p_u->pan[1];
+	u32 s = 0;
+
+#ifdef _PTN_SSE2
+	{
+		const __m128d max  = _mm_set1_pd(INT16_MAX);
+		const __m128d max2 = _mm_set1_pd(INT16_MAX * 2);
+		const __m128d pl   = _mm_set1_pd(pan_l);
+		const __m128d pr   = _mm_set1_pd(pan_r);
+
+		for(; s + 2 <= num; s += 2) {
+			__m128d env  = _mm_loadu_pd(&envs[s]);
+			__m128d work = _mm_loadu_pd(&mains[s]);
+			work = _mm_div_pd(_mm_mul_pd(work, _mm_add_pd(_mm_loadu_pd(&volus[s]), max)), max2);
+			_mm_storeu_pd(&p_l[s], _mm_add_pd(_mm_loadu_pd(&p_l[s]), _mm_mul_pd(_mm_mul_pd(work, pl), env)));
+			_mm_storeu_pd(&p_r[s], _mm_add_pd(_mm_loadu_pd(&p_r[s]), _mm_mul_pd(_mm_mul_pd(work, pr), env)));
+		}
+	}
+#endif
+
+	for(; s < num; ++s) {
+		f64 work = mains[s] * (volus[s] + INT16_MAX) / (INT16_MAX * 2);
+		p_l[s] += work * pan_l * envs[s];
+		p_r[s] += work * pan_r * envs[s];
+	}
+}
+
+/* stores to p_dst interleaved */
+static void _quantize(f64 stores[MPXTN_CH][_BLOCK], u32 num, s16 *p_dst)
+{
+	s32 byte4;
+
+	for(u32 s = 0; s < num; ++s) {
+		for(u32 c = 0; c < MPXTN_CH; ++c) {
+
+			byte4 = (s32)stores[c][s];
 			if(byte4 >   INT16_MAX) byte4 =   INT16_MAX;
 			if(byte4 < - INT16_MAX) byte4 = - INT16_MAX;
 
-			*(p++) = (s16)byte4;
+			*(p_dst++) = (s16)byte4;
+		}
+	}
+}
+
+/* units are summed in order per block */
+static void _build_serial(_UNIT *units, u8 size, u32 smp_num, s16 *p_dst)
+{
+	f64 stores[MPXTN_CH][_BLOCK];
+	f64 *p_stores[MPXTN_CH] = { stores[0], stores[1] };
+
+	for(u32 b = 0; b < smp_num; b += _BLOCK) {
+
+		u32 num = smp_num - b < _BLOCK ? smp_num - b : _BLOCK;
+
+		memset(stores, 0, sizeof(stores));
+
+		for(u8 i = 0; i < size; ++i) {
+			if(!units[i].enable) continue;
+			_unit_render(&units[i], num, p_stores);
 		}
 
-		// increment
-		for(u8 i = 0; i < p_ptn->size; ++i) {
+		_quantize(stores, num, p_dst + (size_t)b * MPXTN_CH);
+	}
+}
+
+typedef struct {
+	_UNIT *units;
+	u8    order[NOISEUNIT_MAX]; /* enabled units */
+	u32   order_num;
+	u32   share_num;   /* share k has order[k], order[k + share_num].. */
+	u32   smp_num;
+	f64   *p_bufs;     /* [2][order_num][MPXTN_CH][_SEGMENT], by segment parity */
+	s32   rendered[2]; /* segments rendered by workers, by parity, atomic */
+	s32   summed;      /* segments summed by the caller, atomic */
+} _UNITJOBS;
+
+typedef struct {
+	_UNITJOBS *p_jobs;
+	u32       share;
+} _UNITWORKER;
+
+static f64 *_segment_buf(const _UNITJOBS *p_jobs, u32 seg, u32 k)
+{
+	return p_jobs->p_bufs + ((size_t)(seg & 1) * p_jobs->order_num + k) * MPXTN_CH * _SEGMENT;
+}
 
-			_UNIT *p_u = &units[i];
+/* one segment of the units of a share to their buffers */
+static void _render_share(_UNITJOBS *p_jobs, u32 share, u32 seg)
+{
+	u32 top = seg * _SEGMENT;
+	u32 seg_smps = p_jobs->smp_num - top < _SEGMENT ? p_jobs->smp_num - top : _SEGMENT;
 
-			if(!p_u->enable) continue;
+	for(u32 k = share; k < p_jobs->order_num; k += p_jobs->share_num) {
 
-			const _OSCILLATOR *p_o = &p_u->freq;
+		_UNIT *p_u = &p_jobs->units[p_jobs->order[k]];
+		f64 *p_l = _segment_buf(p_jobs, seg, k);
+		f64 *p_r = p_l + _SEGMENT;
 
-			switch(p_o->rnd_type)
-			{
-			case _RANDOM_None:
-				offset = (u32)p_o->offset;
-				fre    = (f64)KEY_TOP * p_o->smps[offset] / INT16_MAX;
-				break;
-			case _RANDOM_Saw:
-				fre = p_o->rnd_start + p_o->rnd_margin * p_o->offset / BASIC_SMPS;
-				break;
-			case _RANDOM_Rect:
-				fre = p_o->rnd_start;
-				break;
-			}
+		/* rendering adds to the buffer */
+		memset(p_l, 0, sizeof(f64) * MPXTN_CH * _SEGMENT);
+
+		for(u32 b = 0; b < seg_smps; b += _BLOCK) {
+			u32 num = seg_smps - b < _BLOCK ? seg_smps - b : _BLOCK;
+			f64 *p_dsts[MPXTN_CH] = { p_l + b, p_r + b };
+
+			_unit_render(p_u, num, p_dsts);
+		}
+	}
+}
+
+/* all segments of one share. buffers of a segment are free when
+ * the segment before the last one is summed */
+static void _unit_worker(void *p_arg)
+{
+	_UNITWORKER *p_w = p_arg;
+	_UNITJOBS *p_jobs = p_w->p_jobs;
+	u32 seg_num = (p_jobs->smp_num + _SEGMENT - 1) / _SEGMENT;
+
+	for(u32 seg = 0; seg < seg_num; ++seg) {
+		while(ref_get(&p_jobs->summed) + 1 < (s32)seg) thread_yield();
+
+		_render_share(p_jobs, p_w->share, seg);
+		ref_inc(&p_jobs->rendered[seg & 1]);
+	}
+}
+
+/* shares of units in threads created once, segments are summed in order by
+ * the caller. false if no memory or no thread, or too many units */
+static bool _build_parallel(_UNIT *units, u8 size, u32 smp_num, u32 threads, s16 *p_dst)
+{
+	_UNITJOBS jobs = { 0 };
+	_UNITWORKER ws[NOISEUNIT_MAX];
+	THREAD ths[NOISEUNIT_MAX];
+	u32 th_num  = 0;
+	u32 seg_num = (smp_num + _SEGMENT - 1) / _SEGMENT;
+	f64 stores[MPXTN_CH][_BLOCK];
+
+	/* arrays are of the limit of ptn_read */
+	if(size > NOISEUNIT_MAX) return false;
+
+	jobs.units   = units;
+	jobs.smp_num = smp_num;
 
-			if(p_o->reverse) fre *= -1;
-			fre *= p_o->volume;
+	for(u8 i = 0; i < size; ++i) {
+		if(units[i].enable) jobs.order[jobs.order_num++] = i;
+	}
 
-			_inc_osc(&p_u->main, p_u->main.increment * freq_get((u32)fre));
-			_inc_osc(&p_u->freq, p_u->freq.increment);
-			_inc_osc(&p_u->volu, p_u->volu.increment);
+	/* caller thread has share 0 */
+	jobs.share_num = threads < jobs.order_num ? threads : jobs.order_num;
 
-			// envelope
-			if(p_u->env_index < p_u->env_num) {
+	jobs.p_bufs = malloc(sizeof(f64) * 2 * jobs.order_num * MPXTN_CH * _SEGMENT);
+	if(!jobs.p_bufs) return false;
+
+	for(u32 t = 1; t < jobs.share_num; ++t) {
+		ws[th_num].p_jobs = &jobs;
+		ws[th_num].share  = t;
+		if(!thread_create(&ths[th_num], _unit_worker, &ws[th_num])) break;
+		th_num++;
+	}
+
+	if(!th_num) {
+		free(jobs.p_bufs);
+		return false;
+	}
 
-				p_u->env_count++;
+	for(u32 seg = 0; seg < seg_num; ++seg) {
 
-				if(p_u->env_count >= p_u->envs[p_u->env_index].smp) {
+		u32 top      = seg * _SEGMENT;
+		u32 seg_smps = smp_num - top < _SEGMENT ? smp_num - top : _SEGMENT;
 
-					p_u->env_count      = 0;
-					p_u->env_mag_start  = p_u->envs[p_u->env_index].mag;
-					p_u->env_mag_margin = 0;
-					p_u->env_index++;
+		/* and shares of threads which failed to start */
+		_render_share(&jobs, 0, seg);
+		for(u32 t = th_num + 1; t < jobs.share_num; ++t) _render_share(&jobs, t, seg);
 
-					while(p_u->env_index < p_u->env_num) {
+		/* workers can be a segment ahead, that has the other parity */
+		while(ref_get(&jobs.rendered[seg & 1]) < (s32)((seg / 2 + 1) * th_num)) thread_yield();
 
-						p_u->env_mag_margin = p_u->envs[p_u->env_index].mag - p_u->env_mag_start;
-						if(p_u->envs[p_u->env_index].smp) break;
-						p_u->env_mag_start  = p_u->envs[p_u->env_index].mag;
-						p_u->env_index++;
-					}
+		for(u32 b = 0; b < seg_smps; b += _BLOCK) {
+
+			u32 num = seg_smps - b < _BLOCK ? seg_smps - b : _BLOCK;
+
+			memset(stores, 0, sizeof(stores));
+
+			for(u32 k = 0; k < jobs.order_num; ++k) {
+				for(u32 c = 0; c < MPXTN_CH; ++c) {
+					const f64 *p_src = _segment_buf(&jobs, seg, k) + c * _SEGMENT + b;
+					for(u32 s = 0; s < num; ++s) stores[c][s] += p_src[s];
 				}
 			}
+
+			_quantize(stores, num, p_dst + ((size_t)top + b) * MPXTN_CH);
 		}
+
+		ref_inc(&jobs.summed);
 	}
+
+	for(u32 t = 0; t < th_num; ++t) thread_join(&ths[t]);
+
+	free(jobs.p_bufs);
+
+	return true;
+}
+
+/* -------------------------------------------------------------------------- */
+s16 *ptn_build(PTN *p_ptn, u32 sps, u32 threads, u32 *p_smp_num)
+{
+	bool ret      = false;
+	u32  smp_num  = 0;
+	u32  enables  = 0;
+	s16  *smps    = NULL;
+	_UNIT *units  = NULL;
+
+	if(!p_ptn) goto End;
+	if(!p_ptn->size) goto End;
+	if(!p_ptn->smp_num) goto End;
+	if(!sps) goto End;
+
+	/* smp_num is written in MPXTN_SPS */
+	smp_num = (u32)((f64)p_ptn->smp_num * sps / MPXTN_SPS);
+	if(!smp_num) goto End;
+
+	/* alloc */
+	units = calloc(p_ptn->size, sizeof(_UNIT));
+	if(!units) goto End;
+	smps = calloc(smp_num * MPXTN_CH, sizeof(s16));
+	if(!smps) goto End;
+
+	_ptn_fix(p_ptn);
+
+	for(u8 i = 0; i < p_ptn->size; ++i) {
+		if(!_unit_init(&units[i], &p_ptn->units[i], sps)) goto End;
+		if(units[i].enable) enables++;
+	}
+
+	/* per unit buffers give the same sums, serial if no memory or no thread */
+	if(threads < 2 || enables < 2 || !_build_parallel(units, p_ptn->size, smp_num, threads, smps)) {
+		_build_serial(units, p_ptn->size, smp_num, smps);
+	}
+
+	if(p_smp_num) *p_smp_num = smp_num;
+	ret = true;
 End:
 	if(units) {
 		_units_free(units, p_ptn->size);
 		free(units);
 	}
 
+	if(!ret) {
+		free(smps);
+		smps = NULL;
+	}
+
 	return smps;
 }
 
@@ -86,6 +86,7 @@ typedef struct {
 
 void  ptn_free(PTN *p_ptn);
 bool  ptn_read(PTN *p_ptn, DESCRIPTOR *p_desc);
-s16  *ptn_build(PTN *p_ptn);
+/* threads: units are built in parallel if more than 1, the result is the same */
+s16  *ptn_build(PTN *p_ptn, u32 sps, u32 threads, u32 *p_smp_num);
 
 #endif
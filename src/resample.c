@@ -0,0 +1,248 @@
+/* -----------------------------------------------------------------------------
+ *  libmpxtn by stkchp
+ * -----------------------------------------------------------------------------
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2017 stkchp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * -------------------------------------------------------------------------- */
+#include "common.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define _RESAMPLE_AVX
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define _RESAMPLE_SSE
+#endif
+
+#include "resample.h"
+
+#define _TAP_ALIGN   8    /* taps are multiple of this, for simd */
+#define _TAP_MAX     1024
+#define _PHASE_MAX   1024
+#define _ROLLOFF     0.95 /* cutoff / nyquist */
+
+static const f64 _pi = 3.1415926535897932;
+
+static const u32 _taps [RESAMPLE_NUM] = { 1, 16, 64  };
+static const f64 _betas[RESAMPLE_NUM] = { 0, 6.0, 9.0 };
+
+typedef struct {
+	u32 L;         /* dst step */
+	u32 M;         /* src step */
+	u32 phase_num;
+	u32 tap_num;
+	f32 *coefs;    /* [phase_num][tap_num] */
+} _FILTER;
+
+/* -------------------------------------------------------------------------- */
+static u32 _gcd(u32 a, u32 b)
+{
+	while(b) {
+		u32 t = a % b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+/* modified bessel function of the first kind, order 0 */
+static f64 _bessel_i0(f64 x)
+{
+	f64 sum  = 1.0;
+	f64 term = 1.0;
+
+	for(u32 k = 1; k < 32; ++k) {
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum  += term;
+		if(term < sum * 1e-12) break;
+	}
+	return sum;
+}
+
+static bool _filter_init(_FILTER *p_f, u32 sps, u32 dst_sps, u8 quality)
+{
+	u32 g = _gcd(sps, dst_sps);
+	f64 cutoff = _ROLLOFF;
+	f64 beta = _betas[quality];
+	u32 half;
+
+	p_f->L = dst_sps / g;
+	p_f->M = sps / g;
+	p_f->phase_num = p_f->L < _PHASE_MAX ? p_f->L : _PHASE_MAX;
+
+	/* downsampling, cut at dst nyquist and widen the kernel */
+	if(dst_sps < sps) cutoff *= (f64)dst_sps / sps;
+
+	p_f->tap_num = (u32)ceil(_taps[quality] * _ROLLOFF / cutoff);
+	p_f->tap_num = (p_f->tap_num + _TAP_ALIGN - 1) / _TAP_ALIGN * _TAP_ALIGN;
+	if(p_f->tap_num > _TAP_MAX) p_f->tap_num = _TAP_MAX;
+	half = p_f->tap_num / 2;
+
+	p_f->coefs = malloc(sizeof(f32) * p_f->phase_num * p_f->tap_num);
+	if(!p_f->coefs) return false;
+
+	for(u32 p = 0; p < p_f->phase_num; ++p) {
+		f32 *p_c = &p_f->coefs[p * p_f->tap_num];
+		f64 frac = (f64)p / p_f->phase_num;
+		f64 sum = 0;
+
+		for(u32 t = 0; t < p_f->tap_num; ++t) {
+			/* tap t is for sample (i + t - half + 1) */
+			f64 x = (f64)t - half + 1 - frac;
+			f64 u = x / half;
+			f64 c = 0;
+
+			if(u > -1.0 && u < 1.0) {
+				f64 a = _pi * cutoff * x;
+				c = (x == 0) ? 1.0 : sin(a) / a;
+				c *= _bessel_i0(beta * sqrt(1.0 - u * u));
+			}
+			p_c[t] = (f32)c;
+			sum += c;
+		}
+
+		/* dc gain 1 */
+		for(u32 t = 0; t < p_f->tap_num; ++t) p_c[t] = (f32)(p_c[t] / sum);
+	}
+
+	return true;
+}
+
+static inline f32 _dot(const f32 *p_a, const f32 *p_b, u32 num)
+{
+#if defined(_RESAMPLE_AVX)
+	__m256 acc = _mm256_setzero_ps();
+	f32 tmp[8];
+
+	for(u32 i = 0; i < num; i += 8) {
+		acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(p_a + i), _mm256_loadu_ps(p_b + i)));
+	}
+	_mm256_storeu_ps(tmp, acc);
+	return ((tmp[0] + tmp[4]) + (tmp[1] + tmp[5])) + ((tmp[2] + tmp[6]) + (tmp[3] + tmp[7]));
+#elif defined(_RESAMPLE_SSE)
+	__m128 acc0 = _mm_setzero_ps();
+	__m128 acc1 = _mm_setzero_ps();
+	f32 tmp[4];
+
+	for(u32 i = 0; i < num; i += 8) {
+		acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(p_a + i    ), _mm_loadu_ps(p_b + i    )));
+		acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(p_a + i + 4), _mm_loadu_ps(p_b + i + 4)));
+	}
+	_mm_storeu_ps(tmp, _mm_add_ps(acc0, acc1));
+	return (tmp[0] + tmp[1]) + (tmp[2] + tmp[3]);
+#else
+	f32 sum = 0;
+	for(u32 i = 0; i < num; ++i) sum += p_a[i] * p_b[i];
+	return sum;
+#endif
+}
+
+/* -------------------------------------------------------------------------- */
+static void _resample_nearest(s16 *p_dst, u32 dst_num, const s16 *smps, u16 ch, u32 sps, u32 dst_sps)
+{
+	f64 rate = (f64)sps / dst_sps;
+
+	for(u32 i = 0; i < dst_num; ++i) {
+		u32 src_idx = (u32)(i * rate);
+		for(u16 c = 0; c < ch; ++c) p_dst[i * ch + c] = smps[src_idx * ch + c];
+	}
+}
+
+static bool _resample_sinc(s16 *p_dst, u32 dst_num, const s16 *smps, u32 smp_num, u16 ch,
+                           u32 sps, u32 dst_sps, u8 quality, bool loop)
+{
+	bool ret = false;
+	_FILTER f = {0};
+	f32 *p_x = NULL;
+	u32 pad, x_num;
+
+	if(!_filter_init(&f, sps, dst_sps, quality)) goto End;
+
+	/* one channel with both edges, no bound check in the loop */
+	pad   = f.tap_num;
+	x_num = smp_num + pad * 2;
+	p_x = malloc(sizeof(f32) * x_num);
+	if(!p_x) goto End;
+
+	for(u16 c = 0; c < ch; ++c) {
+
+		for(u32 k = 0; k < x_num; ++k) {
+			s64 idx = (s64)k - pad;
+
+			if(idx < 0 || idx >= smp_num) {
+				if(!loop) {
+					p_x[k] = 0;
+					continue;
+				}
+				idx %= smp_num;
+				if(idx < 0) idx += smp_num;
+			}
+			p_x[k] = smps[idx * ch + c];
+		}
+
+		for(u32 i = 0; i < dst_num; ++i) {
+			u64 pos   = (u64)i * f.M;
+			u64 idx   = pos / f.L;
+			u32 phase = (u32)((pos % f.L) * f.phase_num / f.L);
+			const f32 *p_c = &f.coefs[phase * f.tap_num];
+			const f32 *p_s = &p_x[pad + idx - f.tap_num / 2 + 1];
+
+			f32 v = _dot(p_c, p_s, f.tap_num);
+
+			if(v >  INT16_MAX) v =  INT16_MAX;
+			if(v < -INT16_MAX) v = -INT16_MAX;
+			p_dst[i * ch + c] = (s16)lrintf(v);
+		}
+	}
+
+	ret = true;
+End:
+	free(f.coefs);
+	free(p_x);
+	return ret;
+}
+
+s16 *resample(const s16 *smps, u32 *p_smp_num, u16 ch, u32 sps, u32 dst_sps, u8 quality, bool loop)
+{
+	s16 *p_dst = NULL;
+	u32 smp_num = *p_smp_num;
+
+	if(!smps || !sps || !dst_sps) return NULL;
+	if(quality >= RESAMPLE_NUM) return NULL;
+
+	u32 dst_num = (u32)(((f64)smp_num * dst_sps + sps - 1) / sps);
+
+	p_dst = calloc((size_t)dst_num * ch, sizeof(s16));
+	if(!p_dst) return NULL;
+
+	if(quality == RESAMPLE_NEAREST || !smp_num) {
+		_resample_nearest(p_dst, dst_num, smps, ch, sps, dst_sps);
+	} else if(!_resample_sinc(p_dst, dst_num, smps, smp_num, ch, sps, dst_sps, quality, loop)) {
+		free(p_dst);
+		return NULL;
+	}
+
+	*p_smp_num = dst_num;
+	return p_dst;
+}
@@ -0,0 +1,47 @@
+/* -----------------------------------------------------------------------------
+ *  libmpxtn by stkchp
+ * -----------------------------------------------------------------------------
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2017 stkchp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * -------------------------------------------------------------------------- */
+#ifndef MPXTNLIB_RESAMPLE_H
+#define MPXTNLIB_RESAMPLE_H
+
+#include "common.h"
+
+/* same as MPXTN_RESAMPLE_* */
+enum RESAMPLE {
+	RESAMPLE_NEAREST,// 0
+	RESAMPLE_LOW    ,// 1 windowed sinc, 16 taps
+	RESAMPLE_HIGH   ,// 2 windowed sinc, 64 taps
+
+	RESAMPLE_NUM    ,// 3
+};
+
+/* interleaved smps of ch channels, sps -> dst_sps.
+ * loop: edges are wrapped, else zero.
+ * return new buffer of *p_smp_num samples, NULL if failed. */
+s16 *resample(const s16 *smps, u32 *p_smp_num, u16 ch, u32 sps, u32 dst_sps, u8 quality, bool loop);
+
+#endif
@@ -30,6 +30,10 @@
 #include "descriptor.h"
 #include "error.h"
 
+#include "resample.h"
+#include "thread.h"
+#include "wcache.h"
+
 #include "service.h"
 
 #define VERSIONSIZE 16
@@ -114,10 +118,6 @@ static bool _service_alloc(SERVICE *p_serv)
 		p_serv->woices = calloc(p_serv->woice_num, sizeof(WOICE));
 		if(!p_serv->woices) goto End;
 	}
-	if(p_serv->unit_num) {
-		p_serv->units = calloc(p_serv->unit_num, sizeof(UNIT));
-		if(!p_serv->units) goto End;
-	}
 
 	ret = true;
 End:
@@ -147,20 +147,19 @@ void service_free(SERVICE *p_serv)
 		free(p_serv->woices);
 	}
 
-	if(p_serv->units)  free(p_serv->units);
-
 	memset(p_serv, 0, sizeof(SERVICE));
 }
 
-/* -------------------------------------------------------------------------- */
 
-bool service_tone_init(SERVICE *p_serv)
+/* -------------------------------------------------------------------------- */
+static bool _read_skip(DESCRIPTOR *p_desc)
 {
-	if(!p_serv->valid) return false;
+	s32 size = 0;
+	if(!desc_s32_r(p_desc, &size)) return false;
+	if(!desc_seek(p_desc, size, SEEK_CUR)) return false;
 	return true;
 }
 
-
 /* -------------------------------------------------------------------------- */
 static bool _read_delay(SERVICE *p_serv, DESCRIPTOR *p_desc)
 {
@@ -193,6 +192,63 @@ static bool _read_overdrive(SERVICE *p_serv, DESCRIPTOR *p_desc)
 	return ret;
 }
 
+/* -------------------------------------------------------------------------- */
+static bool _decode_woice_desc(const SERVICE *p_serv, WOICE *p_w, DESCRIPTOR *p_desc, WOICETYPE type)
+{
+	const WOICEOPT *p_opt = &p_serv->woice_opt;
+
+	switch(type)
+	{
+	case WOICE_PCM:  return woice_read_matePCM(p_w, p_desc, p_opt);
+	case WOICE_PTV:  return woice_read_matePTV(p_w, p_desc, p_opt);
+	case WOICE_PTN:  return woice_read_matePTN(p_w, p_desc, p_opt);
+#ifdef MPXTN_OGGVORBIS
+	case WOICE_OGGV: return woice_read_mateOGGV(p_w, p_desc, p_opt);
+#endif
+	default: return false;
+	}
+}
+
+/* p_raw: material chunk without code */
+static bool _decode_woice_raw(const SERVICE *p_serv, WOICE *p_w, const u8 *p_raw, u32 raw_size, WOICETYPE type)
+{
+	DESCRIPTOR desc = {0};
+	bool cache = wcache_enabled();
+
+	if(cache && wcache_get(p_w, p_raw, raw_size, type, &p_serv->woice_opt)) return true;
+
+	if(desc_set_memory(&desc, p_raw, raw_size)) return false;
+	if(!_decode_woice_desc(p_serv, p_w, &desc, type)) return false;
+
+	if(cache) wcache_put(p_w, p_raw, raw_size, type, &p_serv->woice_opt);
+
+	return true;
+}
+
+static bool _decode_woice(const SERVICE *p_serv, WOICE *p_w, DESCRIPTOR *p_desc, WOICETYPE type)
+{
+	bool ret = false;
+	s32 ofs = 0;
+	s32 size = 0;
+	u8 *p_raw = NULL;
+
+	if(!wcache_enabled()) return _decode_woice_desc(p_serv, p_w, p_desc, type);
+
+	/* whole chunk for cache key */
+	if(!desc_tell(p_desc, &ofs)) goto End;
+	if(!desc_s32_r(p_desc, &size) || size < 0) goto End;
+	if(!desc_seek(p_desc, ofs, SEEK_SET)) goto End;
+
+	p_raw = malloc((size_t)size + sizeof(s32));
+	if(!p_raw) goto End;
+	if(!desc_dat_r(p_desc, p_raw, (size_t)size + sizeof(s32))) goto End;
+
+	ret = _decode_woice_raw(p_serv, p_w, p_raw, (u32)size + sizeof(s32), type);
+End:
+	free(p_raw);
+	return ret;
+}
+
 /* -------------------------------------------------------------------------- */
 static bool _read_woice(SERVICE *p_serv, DESCRIPTOR *p_desc, WOICETYPE type)
 {
@@ -203,15 +259,11 @@ static bool _read_woice(SERVICE *p_serv, DESCRIPTOR *p_desc, WOICETYPE type)
 
 	WOICE *p_w = &p_serv->woices[p_serv->woice_idx];
 
-	switch(type)
-	{
-	case WOICE_PCM:  ret = woice_read_matePCM(p_w, p_desc);  break;
-	case WOICE_PTV:  ret = woice_read_matePTV(p_w, p_desc);  break;
-	case WOICE_PTN:  ret = woice_read_matePTN(p_w, p_desc);  break;
-#ifdef MPXTN_OGGVORBIS
-	case WOICE_OGGV: ret = woice_read_mateOGGV(p_w, p_desc); break;
-#endif
-	default: return false;
+	if(p_serv->woice_deferred) {
+		/* decoded after events */
+		ret = _read_skip(p_desc);
+	} else {
+		ret = _decode_woice(p_serv, p_w, p_desc, type);
 	}
 
 	if(ret) p_serv->woice_idx++;
@@ -247,15 +299,6 @@ static mpxtn_err_t _read_unit_num(DESCRIPTOR *p_desc, u32 *p_num)
 }
 
 
-/* -------------------------------------------------------------------------- */
-static bool _read_skip(DESCRIPTOR *p_desc)
-{
-	s32 size = 0;
-	if(!desc_s32_r(p_desc, &size)) return false;
-	if(!desc_seek(p_desc, size, SEEK_CUR)) return false;
-	return true;
-}
-
 /* -------------------------------------------------------------------------- */
 static mpxtn_err_t _read_tune_items(SERVICE *p_serv, DESCRIPTOR *p_desc)
 {
@@ -382,7 +425,9 @@ static mpxtn_err_t _read_info(SERVICE *p_serv, DESCRIPTOR *p_desc)
 	{
 		if(!desc_dat_r(p_desc, code, CODESIZE)) return MPXTN_EDESC;
 
-		switch(_check_tag_code(code))
+		enum _Tag tag = _check_tag_code(code);
+
+		switch(tag)
 		{
 		/* proc */
 		case _TAG_Event : count += evelist_read_event_num(p_desc); break;
@@ -396,7 +441,7 @@ static mpxtn_err_t _read_info(SERVICE *p_serv, DESCRIPTOR *p_desc)
 		/* count */
 #ifndef MPXTN_OGGVORBIS
 		case _TAG_materialOGGV:
-			return MPXTN_EUSEOGG;
+			return MPXTN_EUSEOGGV;
 			break;
 #else
 		case _TAG_materialOGGV:
@@ -405,6 +450,18 @@ static mpxtn_err_t _read_info(SERVICE *p_serv, DESCRIPTOR *p_desc)
 		case _TAG_materialPTV:
 		case _TAG_materialPTN:
 
+			if(p_serv->woice_num < WOICE_MAX) {
+				s32 *p_ofs = &p_serv->woice_offsets[p_serv->woice_num];
+				if(!desc_tell(p_desc, p_ofs)) return MPXTN_EDESC;
+
+				switch(tag)
+				{
+				case _TAG_materialPCM:  p_serv->woice_types[p_serv->woice_num] = WOICE_PCM;  break;
+				case _TAG_materialPTV:  p_serv->woice_types[p_serv->woice_num] = WOICE_PTV;  break;
+				case _TAG_materialPTN:  p_serv->woice_types[p_serv->woice_num] = WOICE_PTN;  break;
+				default:                p_serv->woice_types[p_serv->woice_num] = WOICE_OGGV; break;
+				}
+			}
 			p_serv->woice_num++;
 			if(!_read_skip(p_desc)) return MPXTN_EDESC;
 			break;
@@ -457,15 +514,179 @@ static mpxtn_err_t _read_info(SERVICE *p_serv, DESCRIPTOR *p_desc)
 }
 
 /* -------------------------------------------------------------------------- */
-mpxtn_err_t service_read(SERVICE *p_serv, DESCRIPTOR *p_desc)
+static mpxtn_err_t _woice_err(WOICETYPE type)
+{
+	switch(type)
+	{
+	case WOICE_PCM: return MPXTN_EREADPCM;
+	case WOICE_PTV: return MPXTN_EREADPTV;
+	case WOICE_PTN: return MPXTN_EREADPTN;
+	default:        return MPXTN_EREADOGGV;
+	}
+}
+
+typedef struct {
+	SERVICE *p_serv;
+	u32 num;
+	s32 next;                 /* next job, atomic */
+	u32  idxs [WOICE_MAX];    /* woice index */
+	u8  *p_bufs[WOICE_MAX];   /* material chunk without code */
+	u32  sizes[WOICE_MAX];
+	bool oks  [WOICE_MAX];
+} _WOICEJOBS;
+
+static void _woice_worker(void *p_arg)
+{
+	_WOICEJOBS *p_jobs = p_arg;
+	SERVICE *p_serv = p_jobs->p_serv;
+	s32 j;
+
+	while((j = ref_inc(&p_jobs->next) - 1) < (s32)p_jobs->num) {
+		u32 i = p_jobs->idxs[j];
+
+		p_jobs->oks[j] = _decode_woice_raw(p_serv, &p_serv->woices[i], p_jobs->p_bufs[j], p_jobs->sizes[j],
+		                                   p_serv->woice_types[i]);
+	}
+}
+
+/* load chunks to memory, decode in woice_threads */
+static mpxtn_err_t _read_woices_parallel(SERVICE *p_serv, DESCRIPTOR *p_desc, const bool *used)
+{
+	mpxtn_err_t ret = MPXTN_NOERR;
+	_WOICEJOBS *p_jobs = NULL;
+	THREAD *p_ths = NULL;
+	u32 th_num = 0;
+
+	p_jobs = calloc(1, sizeof(_WOICEJOBS));
+	if(!p_jobs) {
+		ret = MPXTN_ENOMEM;
+		goto End;
+	}
+
+	p_jobs->p_serv = p_serv;
+
+	for(u32 i = 0; i < p_serv->woice_num; ++i) {
+		s32 size = 0;
+		u32 j = p_jobs->num;
+
+		if(!used[i]) continue;
+
+		if(!desc_seek(p_desc, p_serv->woice_offsets[i], SEEK_SET) ||
+		   !desc_s32_r(p_desc, &size) || size < 0 ||
+		   !desc_seek(p_desc, p_serv->woice_offsets[i], SEEK_SET)) {
+			ret = MPXTN_EDESC;
+			goto End;
+		}
+
+		p_jobs->idxs[j]   = i;
+		p_jobs->sizes[j]  = (u32)size + sizeof(s32);
+		p_jobs->p_bufs[j] = malloc(p_jobs->sizes[j]);
+		if(!p_jobs->p_bufs[j]) {
+			ret = MPXTN_ENOMEM;
+			goto End;
+		}
+		p_jobs->num++;
+
+		if(!desc_dat_r(p_desc, p_jobs->p_bufs[j], p_jobs->sizes[j])) {
+			ret = _woice_err(p_serv->woice_types[i]);
+			goto End;
+		}
+	}
+
+	/* caller thread is also a worker */
+	th_num = p_serv->woice_threads - 1;
+	if(th_num > p_jobs->num) th_num = p_jobs->num;
+
+	if(th_num) {
+		p_ths = calloc(th_num, sizeof(THREAD));
+		if(!p_ths) th_num = 0;
+	}
+
+	for(u32 t = 0; t < th_num; ++t) {
+		if(!thread_create(&p_ths[t], _woice_worker, p_jobs)) {
+			th_num = t;
+			break;
+		}
+	}
+
+	_woice_worker(p_jobs);
+
+	for(u32 t = 0; t < th_num; ++t) thread_join(&p_ths[t]);
+
+	/* first error in file order */
+	for(u32 j = 0; j < p_jobs->num; ++j) {
+		if(!p_jobs->oks[j]) {
+			ret = _woice_err(p_serv->woice_types[p_jobs->idxs[j]]);
+			goto End;
+		}
+	}
+
+End:
+	if(p_jobs) {
+		for(u32 j = 0; j < p_jobs->num; ++j) free(p_jobs->p_bufs[j]);
+		free(p_jobs);
+	}
+	free(p_ths);
+	return ret;
+}
+
+/* -------------------------------------------------------------------------- */
+static mpxtn_err_t _read_deferred_woices(SERVICE *p_serv, DESCRIPTOR *p_desc)
+{
+	bool used[WOICE_MAX] = { false };
+
+	if(p_serv->lazy_woice) {
+		/* preflight, voice 0 is set to all units at first */
+		if(p_serv->woice_num) used[0] = true;
+
+		for(const EVERECORD *p = evelist_get_records(&p_serv->evels); p; p = p->next) {
+			if(p->kind == EVENTKIND_VOICENO) used[p->value] = true;
+		}
+	} else {
+		for(u32 i = 0; i < p_serv->woice_num; ++i) used[i] = true;
+	}
+
+	if(p_serv->woice_threads > 1) return _read_woices_parallel(p_serv, p_desc, used);
+
+	for(u32 i = 0; i < p_serv->woice_num; ++i) {
+
+		if(!used[i]) continue;
+
+		if(!desc_seek(p_desc, p_serv->woice_offsets[i], SEEK_SET)) return MPXTN_EDESC;
+
+		if(!_decode_woice(p_serv, &p_serv->woices[i], p_desc, p_serv->woice_types[i])) {
+			return _woice_err(p_serv->woice_types[i]);
+		}
+	}
+
+	return MPXTN_NOERR;
+}
+
+/* -------------------------------------------------------------------------- */
+mpxtn_err_t service_read(SERVICE *p_serv, DESCRIPTOR *p_desc, const SERVICE_OPTION *p_opt)
 {
 	mpxtn_err_t ret = MPXTN_NOERR;
 
 	if(!p_serv) return MPXTN_EINTERNAL;
 	if(!p_desc) return MPXTN_EINTERNAL;
+	if(!p_opt)  return MPXTN_EINTERNAL;
+
+	if(p_opt->sps < MPXTN_SPS_MIN || p_opt->sps > MPXTN_SPS_MAX) return MPXTN_EINVSPS;
+	if(p_opt->resample >= RESAMPLE_NUM) return MPXTN_EINVOPT;
+	if(p_opt->ptv_scale < 1 || p_opt->ptv_scale > WOICE_PTV_SCALE_MAX) return MPXTN_EINVOPT;
 
 	service_free(p_serv);
 
+	p_serv->sps = p_opt->sps;
+	p_serv->woice_opt.sps         = p_opt->sps;
+	p_serv->woice_opt.resample    = p_opt->resample;
+	p_serv->woice_opt.ptv_smp_num = WOICE_PTV_SMPNUM * p_opt->ptv_scale;
+	p_serv->woice_opt.ptv_mip     = p_opt->ptv_mipmap;
+	p_serv->woice_opt.ptn_threads = p_opt->ptn_threads;
+	p_serv->lazy_woice = p_opt->lazy_woice;
+	p_serv->woice_threads = p_opt->woice_threads;
+	p_serv->woice_deferred = p_opt->lazy_woice || p_opt->woice_threads > 1;
+
 	/* read & count event */
 	ret = _read_info(p_serv, p_desc);
 	if(ret != MPXTN_NOERR) goto End;
@@ -496,6 +717,11 @@ mpxtn_err_t service_read(SERVICE *p_serv, DESCRIPTOR *p_desc)
 		goto End;
 	}
 
+	if(p_serv->woice_deferred) {
+		ret = _read_deferred_woices(p_serv, p_desc);
+		if(ret != MPXTN_NOERR) goto End;
+	}
+
 	/* beat clock always default value */
 	if(p_serv->master.beat_clock != EVENTDEFAULT_BEATCLOCK) {
 		ret = MPXTN_EUNKNOWNFMT;
@@ -36,7 +36,7 @@
 #include "evelist.h"
 #include "overdrive.h"
 #include "master.h"
-#include "unit.h"
+#include "woice.h"
 
 typedef struct {
 	bool valid;
@@ -50,18 +50,35 @@ typedef struct {
 	u32 ovdrv_idx;
 	u32 woice_idx;
 	u32 unit_idx;
+	u32 sps; /* output sample rate */
+	WOICEOPT woice_opt;
+	bool lazy_woice; /* decode woices referenced by events only */
+	u32 woice_threads; /* decode woices in worker threads */
+	bool woice_deferred; /* material chunks are decoded after events */
 	MASTER    master;
 	EVELIST   evels;
 	DELAY     *delays;
 	OVERDRIVE *ovdrvs;
-	UNIT      *units;
 	WOICE     *woices;
+	WOICETYPE woice_types[WOICE_MAX];   /* used by woice_deferred */
+	s32       woice_offsets[WOICE_MAX]; /* used by woice_deferred */
 } SERVICE;
 
+/* NOTE: SERVICE is read only after service_read, shared by players.
+ *       delays hold parameters only, buffers are owned by each player. */
+
 void service_free(SERVICE *p_serv);
 
-mpxtn_err_t service_read(SERVICE *p_serv, DESCRIPTOR *p_desc);
+typedef struct {
+	u32  sps;           /* output sample rate */
+	u8   resample;      /* RESAMPLE_* */
+	u32  ptv_scale;     /* PTV wave is WOICE_PTV_SMPNUM x this */
+	bool ptv_mipmap;    /* build band-limited levels of PTV waves */
+	bool lazy_woice;    /* skip woices which no event refers */
+	u32  woice_threads; /* 0, 1: decode in the caller thread */
+	u32  ptn_threads;   /* 0, 1: build PTN units in the decoding thread */
+} SERVICE_OPTION;
 
-bool service_tone_init(SERVICE *p_serv);
+mpxtn_err_t service_read(SERVICE *p_serv, DESCRIPTOR *p_desc, const SERVICE_OPTION *p_opt);
 
 #endif
@@ -0,0 +1,142 @@
+/* -----------------------------------------------------------------------------
+ *  libmpxtn by stkchp
+ * -----------------------------------------------------------------------------
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2017 stkchp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * -------------------------------------------------------------------------- */
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#ifdef MPXTN_THREADS
+#include <process.h>
+#endif
+#else
+#include <sched.h>
+#endif
+
+#include "thread.h"
+
+#ifdef _WIN32
+/* MUTEX.lock holds SRWLOCK */
+typedef char _SRWLOCK_SIZE[sizeof(SRWLOCK) == sizeof(void *) ? 1 : -1];
+#endif
+
+#ifdef MPXTN_THREADS
+
+#ifdef _WIN32
+static unsigned __stdcall _thread_entry(void *p_arg)
+{
+	THREAD *p_th = p_arg;
+	p_th->proc(p_th->p_arg);
+	return 0;
+}
+#else
+static void *_thread_entry(void *p_arg)
+{
+	THREAD *p_th = p_arg;
+	p_th->proc(p_th->p_arg);
+	return NULL;
+}
+#endif
+
+bool thread_create(THREAD *p_th, THREADPROC proc, void *p_arg)
+{
+	if(!p_th || !proc) return false;
+
+	p_th->proc  = proc;
+	p_th->p_arg = p_arg;
+
+#ifdef _WIN32
+	uintptr_t h = _beginthreadex(NULL, 0, _thread_entry, p_th, 0, NULL);
+	if(!h) return false;
+	p_th->handle = (HANDLE)h;
+#else
+	if(pthread_create(&p_th->handle, NULL, _thread_entry, p_th) != 0) return false;
+#endif
+	return true;
+}
+
+void thread_join(THREAD *p_th)
+{
+	if(!p_th) return;
+
+#ifdef _WIN32
+	WaitForSingleObject(p_th->handle, INFINITE);
+	CloseHandle(p_th->handle);
+#else
+	pthread_join(p_th->handle, NULL);
+#endif
+}
+
+#else /* MPXTN_THREADS */
+
+bool thread_create(THREAD *p_th, THREADPROC proc, void *p_arg)
+{
+	(void)p_th;
+	(void)proc;
+	(void)p_arg;
+	return false;
+}
+
+void thread_join(THREAD *p_th)
+{
+	(void)p_th;
+}
+
+#endif /* MPXTN_THREADS */
+
+void thread_yield(void)
+{
+#ifdef _WIN32
+	SwitchToThread();
+#else
+	sched_yield();
+#endif
+}
+
+/* -------------------------------------------------------------------------- */
+
+void mutex_lock(MUTEX *p_mtx)
+{
+#if defined(_WIN32)
+	AcquireSRWLockExclusive((PSRWLOCK)&p_mtx->lock);
+#elif defined(MPXTN_THREADS)
+	pthread_mutex_lock(&p_mtx->lock);
+#else
+	while(__atomic_exchange_n(&p_mtx->lock, 1, __ATOMIC_ACQUIRE)) thread_yield();
+#endif
+}
+
+void mutex_unlock(MUTEX *p_mtx)
+{
+#if defined(_WIN32)
+	ReleaseSRWLockExclusive((PSRWLOCK)&p_mtx->lock);
+#elif defined(MPXTN_THREADS)
+	pthread_mutex_unlock(&p_mtx->lock);
+#else
+	__atomic_store_n(&p_mtx->lock, 0, __ATOMIC_RELEASE);
+#endif
+}
@@ -0,0 +1,84 @@
+/* -----------------------------------------------------------------------------
+ *  libmpxtn by stkchp
+ * -----------------------------------------------------------------------------
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2017 stkchp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * -------------------------------------------------------------------------- */
+#ifndef MPXTNLIB_THREAD_H
+#define MPXTNLIB_THREAD_H
+
+/* no common.h and no windows.h here, POINT of windows.h conflicts with
+ * the one of common.h. windows.h is included only by thread.c */
+#include <stdbool.h>
+
+#if defined(MPXTN_THREADS) && !defined(_WIN32)
+#include <pthread.h>
+#endif
+
+typedef void (*THREADPROC)(void *p_arg);
+
+typedef struct {
+#ifdef MPXTN_THREADS
+#ifdef _WIN32
+	void *handle; /* HANDLE */
+#else
+	pthread_t handle;
+#endif
+#endif
+	THREADPROC proc;
+	void *p_arg;
+} THREAD;
+
+/* mutex locks even without MPXTN_THREADS, because the woice cache is shared
+ * by players of any host thread. a single threaded build links no library */
+typedef struct {
+#if defined(_WIN32)
+	void *lock; /* SRWLOCK, same size */
+#elif defined(MPXTN_THREADS)
+	pthread_mutex_t lock;
+#else
+	volatile int lock; /* spin lock */
+#endif
+} MUTEX;
+
+/* for static MUTEX */
+#if defined(_WIN32)
+#define MUTEX_INITIALIZER { 0 } /* SRWLOCK_INIT */
+#elif defined(MPXTN_THREADS)
+#define MUTEX_INITIALIZER { PTHREAD_MUTEX_INITIALIZER }
+#else
+#define MUTEX_INITIALIZER { 0 }
+#endif
+
+/* false if threads not supported, run proc by caller */
+bool thread_create(THREAD *p_th, THREADPROC proc, void *p_arg);
+void thread_join(THREAD *p_th);
+
+/* gives the cpu to another thread while waiting */
+void thread_yield(void);
+
+void mutex_lock(MUTEX *p_mtx);
+void mutex_unlock(MUTEX *p_mtx);
+
+#endif
@@ -27,6 +27,25 @@
  * -------------------------------------------------------------------------- */
 #include "unit.h"
 
+#include "freq.h"
+#include "interp.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define _UNIT_SSE2
+#endif
+
+/* log2 of VELOCITY_MAX, VOLUME_MAX and PAN_VOLUME_MAX, for simd division */
+#define _VELOCITY_SHIFT   7
+#define _VOLUME_SHIFT     7
+#define _PAN_VOLUME_SHIFT 6
+
+/* samples of one render block per voice, gain is applied in place */
+typedef struct {
+	s32 smps[MPXTN_CH][BUFSIZE_RENDER];
+	s32 envs[BUFSIZE_RENDER];
+	s32 lives[BUFSIZE_RENDER];
+} _VOICEBLOCK;
 
 void unit_tone_init(UNIT *p_u)
 {
@@ -41,6 +60,10 @@ void unit_tone_init(UNIT *p_u)
 	p_u->pan_vols[0] = PAN_VOLUME_MAX;
 	p_u->pan_vols[1] = PAN_VOLUME_MAX;
 
+	p_u->quiet_num = BUFSIZE_TIMEPAN;
+
+	p_u->pitch_dirty = true;
+
 	p_u->operated = true;
 	p_u->played = true;
 }
@@ -60,6 +83,8 @@ void unit_tone_reset_and_2prm(UNIT *p_u, u32 voice_idx, s32 clock, f64 offset_fr
 	p_ut->smooth_volume     = 0;
 	p_ut->env_release_clock = clock;
 	p_ut->offset_freq       = offset_freq;
+
+	p_u->pitch_dirty = true;
 }
 
 void unit_set_woice(UNIT *p_u, const WOICE *p_woice)
@@ -68,6 +93,8 @@ void unit_set_woice(UNIT *p_u, const WOICE *p_woice)
 	p_u->key_now    = EVENTDEFAULT_KEY;
 	p_u->key_margin = 0;
 	p_u->key_start  = EVENTDEFAULT_KEY;
+
+	p_u->pitch_dirty = true;
 }
 
 void unit_tone_zerolives(UNIT *p_u)
@@ -82,6 +109,8 @@ void unit_tone_keyon(UNIT *p_u)
 	p_u->key_now    = p_u->key_start + p_u->key_margin;
 	p_u->key_start  = p_u->key_now;
 	p_u->key_margin = 0;
+
+	p_u->pitch_dirty = true;
 }
 
 void unit_tone_key(UNIT *p_u, s32 key)
@@ -89,6 +118,8 @@ void unit_tone_key(UNIT *p_u, s32 key)
 	p_u->key_start  = p_u->key_now;
 	p_u->key_margin = key - p_u->key_start;
 	p_u->pm_smp_pos = 0;
+
+	p_u->pitch_dirty = true;
 }
 
 void unit_tone_pan_volume(UNIT *p_u, s32 pan)
@@ -134,6 +165,7 @@ void unit_tone_portament(UNIT *p_u, s32 val)
 {
 	if(val < 0) val = 0;
 	p_u->pm_smp_num = val;
+	p_u->pitch_dirty = true;
 }
 void unit_tone_groupno(UNIT *p_u, s32 val)
 {
@@ -143,6 +175,79 @@ void unit_tone_groupno(UNIT *p_u, s32 val)
 void unit_tone_tuning(UNIT *p_u, f32 val)
 {
 	p_u->tuning = (f64)val;
+	p_u->pitch_dirty = true;
+}
+
+/* -----------------------------------------------------------------------------
+ * NOTE: value at env_pos is linear between breakpoints,
+ *       start.y + dy * (env_pos - start.x) / dx.
+ *       the division is proceeded by addition per sample.
+ */
+static s32 _envelope_on(const WOICEINSTANCE *p_wi, UNITTONE *p_ut)
+{
+	const POINT *pts = p_wi->env_pts;
+	u32 num = p_wi->env_pt_num;
+	u32 s   = (u32)p_ut->env_pos;
+	POINT start = {0, 0};
+
+	if(s == 0) {
+		p_ut->env_seg = 0;
+		p_ut->env_q   = 0;
+		p_ut->env_r   = 0;
+	}
+
+	if(p_ut->env_seg) start = pts[p_ut->env_seg - 1];
+
+	/* next sample of the segment */
+	if(s && p_ut->env_seg < num) {
+		s32 dx  = pts[p_ut->env_seg].x - start.x;
+		s32 ady = abs(pts[p_ut->env_seg].y - start.y);
+
+		p_ut->env_r += ady;
+		while(p_ut->env_r >= dx) {
+			p_ut->env_r -= dx;
+			p_ut->env_q++;
+		}
+	}
+
+	/* enter next segment */
+	if(p_ut->env_seg < num && s >= (u32)pts[p_ut->env_seg].x) {
+
+		while(p_ut->env_seg < num && s >= (u32)pts[p_ut->env_seg].x) p_ut->env_seg++;
+		start = pts[p_ut->env_seg - 1];
+
+		if(p_ut->env_seg < num) {
+			s32 dx   = pts[p_ut->env_seg].x - start.x;
+			s64 work = (s64)abs(pts[p_ut->env_seg].y - start.y) * ((s32)s - start.x);
+
+			p_ut->env_q = (s32)(work / dx);
+			p_ut->env_r = (s32)(work % dx);
+		}
+	}
+
+	if(p_ut->env_seg < num) {
+		if(pts[p_ut->env_seg].y < start.y) return (u8)(start.y - p_ut->env_q);
+		else                               return (u8)(start.y + p_ut->env_q);
+	}
+
+	return (u8)start.y;
+}
+
+/* env_start - env_start * env_pos / env_release */
+static s32 _envelope_release(const WOICEINSTANCE *p_wi, UNITTONE *p_ut)
+{
+	if(p_ut->env_pos == 0) {
+		p_ut->env_q = 0;
+		p_ut->env_r = 0;
+	} else {
+		p_ut->env_r += p_ut->env_start;
+		while(p_ut->env_r >= p_wi->env_release) {
+			p_ut->env_r -= p_wi->env_release;
+			p_ut->env_q++;
+		}
+	}
+
+	return p_ut->env_start - p_ut->env_q;
 }
 
 void unit_tone_envelope(UNIT *p_u)
@@ -160,75 +265,130 @@ void unit_tone_envelope(UNIT *p_u)
 
 				if(p_ut->env_pos < (s32)p_wi->env_num) {
 
-					p_ut->env_volume = p_wi->envs[p_ut->env_pos];
+					p_ut->env_volume = _envelope_on(p_wi, p_ut);
 					p_ut->env_pos++;
 				}
 
-			} else {
+			} else if(p_wi->env_release > 0) {
 
-				p_ut->env_volume = p_ut->env_start - p_ut->env_start * p_ut->env_pos / p_wi->env_release;
+				p_ut->env_volume = _envelope_release(p_wi, p_ut);
 				p_ut->env_pos++;
 			}
 		}
 	}
 }
 
-void unit_tone_sample(UNIT *p_u, u32 time_pan_index, s32 smooth_smp)
+/* samples of all alive tones at the current position, before gain */
+static inline void _fetch_sample(const UNIT *p_u, _VOICEBLOCK *p_vbs, u32 i, u8 interp)
 {
+	for(u32 v = 0; v < p_u->p_woice->size; ++v) {
 
-	u32 pos;
-	s32 work;
-	s32 time_pan_buf;
+		const WOICEINSTANCE *p_wi = &p_u->p_woice->insts[v];
+		const UNITTONE *p_ut = &p_u->uts[v];
+		_VOICEBLOCK *p_vb = &p_vbs[v];
 
-	if(!p_u->played) {
-		p_u->pan_time_bufs[0][time_pan_index] = 0;
-		p_u->pan_time_bufs[1][time_pan_index] = 0;
-		return;
-	}
+		p_vb->lives[i] = p_ut->life_count;
+
+		/* zero stays zero through the gain */
+		if(p_ut->life_count <= 0) {
+			p_vb->smps[0][i] = 0;
+			p_vb->smps[1][i] = 0;
+			p_vb->envs[i]    = 0;
+			continue;
+		}
+
+		s32 smps[MPXTN_CH];
 
-	for(u32 ch = 0; ch < MPXTN_CH; ++ch) {
+		const s16 *p_src   = p_wi->smps;
+		u32        smp_num = p_wi->smp_num;
+		u64        pos     = p_ut->smp_pos;
 
-		time_pan_buf = 0;
+		/* band-limited level, mip may be of the previous voice until the step is updated */
+		if(p_ut->mip && p_wi->mip_num) {
+			const WOICEMIP *p_m = &p_wi->mips[(p_ut->mip < p_wi->mip_num ? p_ut->mip : p_wi->mip_num) - 1];
+			p_src   = p_m->smps;
+			smp_num = p_m->smp_num;
+			pos   >>= p_m->shift;
+		}
 
-		for(u32 v = 0; v < p_u->p_woice->size; ++v) {
+		if(interp != INTERP_NONE) {
+			interp_sample(p_src, smp_num, p_wi->ch, p_wi->waveloop, pos, interp, smps);
+		} else if(p_wi->ch == 1) {
+			/* mono, read once for both pan gains */
+			smps[0] = p_src[(u32)(pos >> 32)];
+			smps[1] = smps[0];
+		} else {
+			const s16 *p_smp = &p_src[(u32)(pos >> 32) * 2];
+			smps[0] = p_smp[0];
+			smps[1] = p_smp[1];
+		}
 
-			const WOICEINSTANCE *p_wi = &p_u->p_woice->insts[v];
-			UNITTONE *p_ut = &p_u->uts[v];
+		p_vb->smps[0][i] = smps[0];
+		p_vb->smps[1][i] = smps[1];
 
-			work = 0;
+		/* x * VOLUME_MAX / VOLUME_MAX is x, same as no envelope */
+		p_vb->envs[i] = p_wi->env_num ? p_ut->env_volume : VOLUME_MAX;
+	}
+}
 
-			if(p_ut->life_count > 0) {
+#ifdef _UNIT_SSE2
+/* low 32 bits of 32 x 32 bits products, same for signed */
+static inline __m128i _mullo_epi32(__m128i a, __m128i b)
+{
+	__m128i even = _mm_mul_epu32(a, b);
+	__m128i odd  = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
 
-				pos = (u32)(p_ut->smp_pos) * 2 + ch;
-				work += p_wi->smps[pos];
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+	                          _mm_shuffle_epi32(odd,  _MM_SHUFFLE(0, 0, 2, 0)));
+}
 
-				work = work * p_u->velocity     / VELOCITY_MAX;
-				work = work * p_u->volume       / VOLUME_MAX;
-				work = work * p_u->pan_vols[ch] / PAN_VOLUME_MAX;
+/* a / 2^shift, rounded toward zero as C division */
+#define _DIV_POW2(a, shift) \
+	_mm_srai_epi32(_mm_add_epi32((a), _mm_srli_epi32(_mm_srai_epi32((a), 31), 32 - (shift))), (shift))
+#endif
 
-				if(p_wi->env_num) work = work * p_ut->env_volume / VOLUME_MAX;
+/* -----------------------------------------------------------------------------
+ * NOTE: gain of one channel in place, rounded at every step as
+ *       smp * velocity / VELOCITY_MAX * volume / VOLUME_MAX
+ *           * pan_vol / PAN_VOLUME_MAX * env / VOLUME_MAX
+ */
+static void _gain_block(s32 *p_smps, const s32 *p_envs, s32 velocity, s32 volume, s32 pan_vol, u32 num)
+{
+	u32 i = 0;
 
-				/* smooth tail */
-				if(p_wi->smooth && p_ut->life_count < smooth_smp) {
-					work = work * p_ut->life_count / smooth_smp;
-				}
-			}
+#ifdef _UNIT_SSE2
+	const __m128i vel = _mm_set1_epi32(velocity);
+	const __m128i vol = _mm_set1_epi32(volume);
+	const __m128i pan = _mm_set1_epi32(pan_vol);
 
-			time_pan_buf += work;
-		}
+	for(; i + 4 <= num; i += 4) {
+		__m128i x   = _mm_loadu_si128((const __m128i*)(p_smps + i));
+		__m128i env = _mm_loadu_si128((const __m128i*)(p_envs + i));
 
-		p_u->pan_time_bufs[ch][time_pan_index] = time_pan_buf;
+		x = _mullo_epi32(x, vel); x = _DIV_POW2(x, _VELOCITY_SHIFT  );
+		x = _mullo_epi32(x, vol); x = _DIV_POW2(x, _VOLUME_SHIFT    );
+		x = _mullo_epi32(x, pan); x = _DIV_POW2(x, _PAN_VOLUME_SHIFT);
+		x = _mullo_epi32(x, env); x = _DIV_POW2(x, _VOLUME_SHIFT    );
+
+		_mm_storeu_si128((__m128i*)(p_smps + i), x);
 	}
-}
+#endif
+	for(; i < num; ++i) {
+		s32 work = p_smps[i];
 
-void unit_tone_supple(const UNIT *p_u, s32 *group_smps, u32 ch, u32 time_pan_index)
-{
-	u32 idx = (time_pan_index - p_u->pan_times[ch]) & ((u32)BUFSIZE_TIMEPAN - 1);
-	group_smps[p_u->groupno] += p_u->pan_time_bufs[ch][idx];
+		work = work * velocity  / VELOCITY_MAX;
+		work = work * volume    / VOLUME_MAX;
+		work = work * pan_vol   / PAN_VOLUME_MAX;
+		work = work * p_envs[i] / VOLUME_MAX;
+
+		p_smps[i] = work;
+	}
 }
 
 s32 unit_tone_increment_key(UNIT *p_u)
 {
+	s32 key_old = p_u->key_now;
+
 	// portamento..
 	if(p_u->pm_smp_num && p_u->key_margin) {
 
@@ -249,11 +409,37 @@ s32 unit_tone_increment_key(UNIT *p_u)
 		p_u->key_now = p_u->key_start + p_u->key_margin;
 	}
 
+	if(p_u->key_now != key_old) p_u->pitch_dirty = true;
+
 	return p_u->key_now;
 }
 
-void unit_tone_increment_sample(UNIT *p_u, f64 freq)
+/* step of the phase accumulator, recalculated only if key, tuning or voice is changed */
+static void _update_steps(UNIT *p_u)
 {
+	f64 freq = freq_get2(p_u->key_now);
+
+	for(u32 i = 0; i < p_u->p_woice->size; ++i) {
+		UNITTONE *p_ut = &p_u->uts[i];
+		f64 step = p_ut->offset_freq * p_u->tuning * freq;
+
+		if(step > 0) p_ut->smp_step = (u64)(step * 4294967296.0 + 0.5);
+		else         p_ut->smp_step = 0;
+
+		/* level k is for steps up to 2^k */
+		const WOICEINSTANCE *p_wi = &p_u->p_woice->insts[i];
+		u32 mip = 0;
+		while(mip < p_wi->mip_num && p_ut->smp_step > ((u64)1 << (32 + mip))) mip++;
+		p_ut->mip = mip;
+	}
+
+	p_u->pitch_dirty = false;
+}
+
+void unit_tone_increment_sample(UNIT *p_u)
+{
+	if(p_u->pitch_dirty) _update_steps(p_u);
+
 	for(u32 i = 0; i < p_u->p_woice->size; ++i) {
 
 		const WOICEINSTANCE *p_wi = &p_u->p_woice->insts[i];
@@ -262,16 +448,18 @@ void unit_tone_increment_sample(UNIT *p_u, f64 freq)
 		if(p_ut->life_count > 0) p_ut->life_count--;
 		if(p_ut->life_count > 0) {
 
+			u64 smp_end = (u64)p_wi->smp_num << 32;
+
 			p_ut->on_count--;
 
-			p_ut->smp_pos += p_ut->offset_freq * p_u->tuning * freq;
+			p_ut->smp_pos += p_ut->smp_step;
 
-			if(p_ut->smp_pos >= p_wi->smp_num) {
+			if(p_ut->smp_pos >= smp_end) {
 
 				if(p_wi->waveloop) {
 
-					if(p_ut->smp_pos >= p_wi->smp_num) p_ut->smp_pos -= p_wi->smp_num;
-					if(p_ut->smp_pos >= p_wi->smp_num) p_ut->smp_pos  = 0;
+					if(p_ut->smp_pos >= smp_end) p_ut->smp_pos -= smp_end;
+					if(p_ut->smp_pos >= smp_end) p_ut->smp_pos  = 0;
 
 				} else {
 					p_ut->life_count = 0;
@@ -289,3 +477,123 @@ void unit_tone_increment_sample(UNIT *p_u, f64 freq)
 	}
 }
 
+/* -----------------------------------------------------------------------------
+ * NOTE: envelope of the first sample must be processed by caller,
+ *       because events are proceeded between envelope and sampling.
+ *       smp_num must be BUFSIZE_RENDER or less. interp: INTERP_*
+ */
+void unit_tone_render(UNIT *p_u, s32 *p_dst, u32 time_pan_index, s32 smooth_smp, u8 interp, u32 smp_num)
+{
+	/* time pan history and samples of this block, in order */
+	s32 bufs[MPXTN_CH][BUFSIZE_TIMEPAN + BUFSIZE_RENDER];
+	_VOICEBLOCK vbs[WOICEINSTANCE_MAX];
+	u32 ch, i, v;
+
+	for(ch = 0; ch < MPXTN_CH; ++ch) {
+		for(i = 0; i < BUFSIZE_TIMEPAN; ++i) {
+			bufs[ch][i] = p_u->pan_time_bufs[ch][(time_pan_index + i) & (BUFSIZE_TIMEPAN - 1)];
+		}
+		memset(&bufs[ch][BUFSIZE_TIMEPAN], 0, smp_num * sizeof(s32));
+	}
+
+	/* sampling, tone state proceeds per sample */
+	for(i = 0; i < smp_num; ++i) {
+
+		if(i) unit_tone_envelope(p_u);
+
+		if(p_u->played) _fetch_sample(p_u, vbs, i, interp);
+
+		/* key is changed only by events or portamento */
+		if(p_u->pitch_dirty || (p_u->pm_smp_num && p_u->key_margin)) unit_tone_increment_key(p_u);
+		unit_tone_increment_sample(p_u);
+	}
+
+	/* gain and mix of the voices */
+	for(v = 0; p_u->played && v < p_u->p_woice->size; ++v) {
+
+		const WOICEINSTANCE *p_wi = &p_u->p_woice->insts[v];
+		_VOICEBLOCK *p_vb = &vbs[v];
+
+		for(ch = 0; ch < MPXTN_CH; ++ch) {
+
+			s32 *p_smps = p_vb->smps[ch];
+
+			_gain_block(p_smps, p_vb->envs, p_u->velocity, p_u->volume, p_u->pan_vols[ch], smp_num);
+
+			/* smooth tail */
+			if(p_wi->smooth) {
+				for(i = 0; i < smp_num; ++i) {
+					if(p_vb->lives[i] > 0 && p_vb->lives[i] < smooth_smp) {
+						p_smps[i] = p_smps[i] * p_vb->lives[i] / smooth_smp;
+					}
+				}
+			}
+
+			for(i = 0; i < smp_num; ++i) bufs[ch][BUFSIZE_TIMEPAN + i] += p_smps[i];
+		}
+	}
+
+	for(i = 0; i < smp_num; ++i) {
+		if(bufs[0][BUFSIZE_TIMEPAN + i] || bufs[1][BUFSIZE_TIMEPAN + i]) p_u->quiet_num = 0;
+		else if(p_u->quiet_num < BUFSIZE_TIMEPAN)                         p_u->quiet_num++;
+	}
+
+	/* supple with time pan */
+	for(ch = 0; ch < MPXTN_CH; ++ch) {
+		const s32 *p_src = &bufs[ch][BUFSIZE_TIMEPAN - p_u->pan_times[ch]];
+		for(i = 0; i < smp_num; ++i) {
+			p_dst[i * MPXTN_CH + ch] += p_src[i];
+		}
+	}
+
+	/* keep history */
+	for(ch = 0; ch < MPXTN_CH; ++ch) {
+		for(i = 0; i < BUFSIZE_TIMEPAN; ++i) {
+			p_u->pan_time_bufs[ch][(time_pan_index + smp_num + i) & (BUFSIZE_TIMEPAN - 1)] = bufs[ch][smp_num + i];
+		}
+	}
+}
+
+/* no alive tone and no time pan tail */
+bool unit_tone_silent(const UNIT *p_u)
+{
+	if(p_u->p_woice) {
+		for(u32 i = 0; i < p_u->p_woice->size; ++i) {
+			if(p_u->uts[i].life_count > 0) return false;
+		}
+	}
+
+	return p_u->quiet_num >= BUFSIZE_TIMEPAN;
+}
+
+/* -----------------------------------------------------------------------------
+ * NOTE: same as unit_tone_render while silent,
+ *       only the portamento has to be proceeded.
+ */
+void unit_tone_skip(UNIT *p_u, u32 smp_num)
+{
+	if(p_u->pm_smp_num && p_u->key_margin) {
+
+		s32 rest = 0;
+		if(p_u->pm_smp_pos < p_u->pm_smp_num) rest = p_u->pm_smp_num - p_u->pm_smp_pos;
+
+		if(smp_num <= (u32)rest) {
+
+			p_u->pm_smp_pos += (s32)smp_num;
+			p_u->key_now = p_u->key_start + p_u->key_margin * p_u->pm_smp_pos / p_u->pm_smp_num;
+
+		} else {
+
+			if(rest) p_u->pm_smp_pos = p_u->pm_smp_num;
+			p_u->key_now    = p_u->key_start + p_u->key_margin;
+			p_u->key_start  = p_u->key_now;
+			p_u->key_margin = 0;
+
+		}
+
+	} else {
+		p_u->key_now = p_u->key_start + p_u->key_margin;
+	}
+
+	p_u->pitch_dirty = true;
+}
@@ -34,13 +34,18 @@
 
 typedef struct
 {
-	f64 smp_pos    ;
+	u64 smp_pos    ; /* 32.32 fixed point */
+	u64 smp_step   ; /* 32.32 fixed point, for UNIT.key_now */
+	u32 mip        ; /* WOICEINSTANCE.mips level for smp_step, 0: smps */
 	f64 offset_freq;
 	s32 life_count ;
 	s32 on_count   ;
 	u32 smp_count  ;
 	s32 env_start  ;
 	s32 env_pos    ;
+	u32 env_seg    ; /* next breakpoint */
+	s32 env_q      ; /* ramp of the segment or release, */
+	s32 env_r      ; /* quotient and remainder */
 	s32 env_volume ;
 	s32 env_release_clock;
 	s32 smooth_volume;
@@ -57,10 +62,14 @@ typedef struct {
 	s32 pan_vols[MPXTN_CH];
 	u32 pan_times[MPXTN_CH];
 	s32 pan_time_bufs[MPXTN_CH][BUFSIZE_TIMEPAN];
+	u32 quiet_num; /* continuous silent samples in pan_time_bufs */
 	s32 volume;
 	s32 velocity;
 	u8  groupno;
 	f64 tuning;
+	bool pitch_dirty; /* key, tuning or voice is changed, UNITTONE.smp_step is old */
+	bool culled;      /* silent and out of the player's active list */
+	u32  culled_smp;  /* player sample count unit_tone_skip is proceeded to */
 	const WOICE *p_woice;
 	UNITTONE uts[WOICEINSTANCE_MAX];
 } UNIT;
@@ -84,12 +93,13 @@ void unit_tone_tuning(UNIT *p_u, f32 val);
 
 void unit_tone_envelope(UNIT *p_u);
 
-void unit_tone_sample(UNIT *p_u, u32 time_pan_index, s32 smooth_smp);
+s32  unit_tone_increment_key(UNIT *p_u);
+void unit_tone_increment_sample(UNIT *p_u);
 
-void unit_tone_supple(const UNIT *p_u, s32 *group_smps, u32 ch, u32 time_pan_index);
+bool unit_tone_silent(const UNIT *p_u);
+void unit_tone_skip(UNIT *p_u, u32 smp_num);
 
-s32  unit_tone_increment_key(UNIT *p_u);
-void unit_tone_increment_sample(UNIT *p_u, f64 freq);
+void unit_tone_render(UNIT *p_u, s32 *p_dst, u32 time_pan_index, s32 smooth_smp, u8 interp, u32 smp_num);
 
 void unit_set_woice(UNIT *p_u, const WOICE *p_w);
 
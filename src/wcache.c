@@ -0,0 +1,273 @@
+/* -----------------------------------------------------------------------------
+ *  libmpxtn by stkchp
+ * -----------------------------------------------------------------------------
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2017 stkchp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * -------------------------------------------------------------------------- */
+#include "common.h"
+
+#include "thread.h"
+#include "woice.h"
+
+#include "wcache.h"
+
+typedef struct _WCACHE_ENTRY {
+	struct _WCACHE_ENTRY *prev; /* LRU, head is newest */
+	struct _WCACHE_ENTRY *next;
+	u64       hash;
+	WOICETYPE type;
+	WOICEOPT  opt;
+	u8        *p_raw;
+	u32       raw_size;
+	size_t    bytes;
+	s32       ref;   /* cache itself and woices, atomic */
+	WOICE     woice; /* owner of instances */
+} _WCACHE_ENTRY;
+
+static MUTEX _mtx = MUTEX_INITIALIZER;
+static _WCACHE_ENTRY *_head;
+static _WCACHE_ENTRY *_tail;
+static size_t _budget;
+static size_t _total;
+
+/* -------------------------------------------------------------------------- */
+static u64 _hash(const u8 *p_raw, u32 raw_size, WOICETYPE type, const WOICEOPT *p_opt)
+{
+	/* FNV-1a */
+	u64 h = 0xcbf29ce484222325ULL;
+
+	for(u32 i = 0; i < raw_size; ++i) {
+		h ^= p_raw[i];
+		h *= 0x100000001b3ULL;
+	}
+	h ^= (u64)type;
+	h *= 0x100000001b3ULL;
+	h ^= (u64)p_opt->sps;
+	h *= 0x100000001b3ULL;
+	h ^= (u64)p_opt->resample;
+	h *= 0x100000001b3ULL;
+	h ^= (u64)p_opt->ptv_smp_num;
+	h *= 0x100000001b3ULL;
+	h ^= (u64)p_opt->ptv_mip;
+	h *= 0x100000001b3ULL;
+
+	return h;
+}
+
+static size_t _woice_bytes(const WOICE *p_woice)
+{
+	size_t bytes = p_woice->size * sizeof(WOICEINSTANCE);
+
+	for(u32 i = 0; i < p_woice->size; ++i) {
+		const WOICEINSTANCE *p_wi = &p_woice->insts[i];
+		bytes += (size_t)p_wi->smp_num * p_wi->ch * sizeof(s16);
+		bytes += (size_t)p_wi->env_pt_num * sizeof(POINT);
+		bytes += (size_t)p_wi->mip_num * sizeof(WOICEMIP);
+		for(u32 m = 0; m < p_wi->mip_num; ++m) bytes += (size_t)p_wi->mips[m].smp_num * p_wi->ch * sizeof(s16);
+	}
+	return bytes;
+}
+
+static void _entry_free(_WCACHE_ENTRY *p_ent)
+{
+	woice_free(&p_ent->woice);
+	free(p_ent->p_raw);
+	free(p_ent);
+}
+
+static void _share(WOICE *p_woice, _WCACHE_ENTRY *p_ent)
+{
+	ref_inc(&p_ent->ref);
+	*p_woice = p_ent->woice;
+	p_woice->p_cache = p_ent;
+}
+
+/* lock held */
+static void _unlink(_WCACHE_ENTRY *p_ent)
+{
+	if(p_ent->prev) p_ent->prev->next = p_ent->next;
+	else            _head = p_ent->next;
+	if(p_ent->next) p_ent->next->prev = p_ent->prev;
+	else            _tail = p_ent->prev;
+
+	p_ent->prev = NULL;
+	p_ent->next = NULL;
+	_total -= p_ent->bytes;
+}
+
+static void _link_head(_WCACHE_ENTRY *p_ent)
+{
+	p_ent->prev = NULL;
+	p_ent->next = _head;
+	if(_head) _head->prev = p_ent;
+	else      _tail = p_ent;
+	_head = p_ent;
+	_total += p_ent->bytes;
+}
+
+static _WCACHE_ENTRY *_find(u64 hash, const u8 *p_raw, u32 raw_size, WOICETYPE type, const WOICEOPT *p_opt)
+{
+	for(_WCACHE_ENTRY *p = _head; p; p = p->next) {
+		if(p->hash != hash || p->type != type) continue;
+		if(p->opt.sps != p_opt->sps || p->opt.resample != p_opt->resample) continue;
+		if(p->opt.ptv_smp_num != p_opt->ptv_smp_num || p->opt.ptv_mip != p_opt->ptv_mip) continue;
+		if(p->raw_size != raw_size) continue;
+		if(memcmp(p->p_raw, p_raw, raw_size)) continue;
+		return p;
+	}
+	return NULL;
+}
+
+/* drop least recently used until under budget, return entries to free */
+static _WCACHE_ENTRY *_evict(void)
+{
+	_WCACHE_ENTRY *p_drop = NULL;
+
+	while(_tail && _total > _budget) {
+		_WCACHE_ENTRY *p_ent = _tail;
+		_unlink(p_ent);
+		if(ref_dec(&p_ent->ref) == 0) {
+			p_ent->next = p_drop;
+			p_drop = p_ent;
+		}
+	}
+	return p_drop;
+}
+
+static void _free_list(_WCACHE_ENTRY *p_drop)
+{
+	while(p_drop) {
+		_WCACHE_ENTRY *p_next = p_drop->next;
+		_entry_free(p_drop);
+		p_drop = p_next;
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+void wcache_set_budget(size_t bytes)
+{
+	_WCACHE_ENTRY *p_drop;
+
+	mutex_lock(&_mtx);
+	_budget = bytes;
+	p_drop = _evict();
+	mutex_unlock(&_mtx);
+
+	_free_list(p_drop);
+}
+
+bool wcache_enabled(void)
+{
+	bool ret;
+
+	mutex_lock(&_mtx);
+	ret = _budget > 0;
+	mutex_unlock(&_mtx);
+
+	return ret;
+}
+
+bool wcache_get(WOICE *p_woice, const void *p_raw, u32 raw_size, WOICETYPE type, const WOICEOPT *p_opt)
+{
+	u64 hash = _hash(p_raw, raw_size, type, p_opt);
+	_WCACHE_ENTRY *p_ent;
+
+	mutex_lock(&_mtx);
+	p_ent = _find(hash, p_raw, raw_size, type, p_opt);
+	if(p_ent) {
+		/* move to head */
+		_unlink(p_ent);
+		_link_head(p_ent);
+		_share(p_woice, p_ent);
+	}
+	mutex_unlock(&_mtx);
+
+	return p_ent != NULL;
+}
+
+void wcache_put(WOICE *p_woice, const void *p_raw, u32 raw_size, WOICETYPE type, const WOICEOPT *p_opt)
+{
+	_WCACHE_ENTRY *p_ent = NULL;
+	_WCACHE_ENTRY *p_drop = NULL;
+	_WCACHE_ENTRY *p_same;
+
+	if(p_woice->p_cache) return;
+
+	p_ent = calloc(1, sizeof(_WCACHE_ENTRY));
+	if(!p_ent) return;
+
+	p_ent->p_raw = malloc(raw_size ? raw_size : 1);
+	if(!p_ent->p_raw) {
+		free(p_ent);
+		return;
+	}
+	memcpy(p_ent->p_raw, p_raw, raw_size);
+
+	p_ent->hash     = _hash(p_raw, raw_size, type, p_opt);
+	p_ent->type     = type;
+	p_ent->opt      = *p_opt;
+	p_ent->raw_size = raw_size;
+	p_ent->bytes    = _woice_bytes(p_woice) + raw_size + sizeof(_WCACHE_ENTRY);
+	p_ent->ref      = 1;
+
+	mutex_lock(&_mtx);
+
+	/* decoded by another thread meanwhile */
+	p_same = _find(p_ent->hash, p_raw, raw_size, type, p_opt);
+	if(p_same) {
+		woice_free(p_woice);
+		_share(p_woice, p_same);
+		mutex_unlock(&_mtx);
+		free(p_ent->p_raw);
+		free(p_ent);
+		return;
+	}
+
+	if(p_ent->bytes > _budget) {
+		mutex_unlock(&_mtx);
+		free(p_ent->p_raw);
+		free(p_ent);
+		return;
+	}
+
+	p_ent->woice = *p_woice;
+	_link_head(p_ent);
+	_share(p_woice, p_ent);
+
+	p_drop = _evict();
+
+	mutex_unlock(&_mtx);
+
+	_free_list(p_drop);
+}
+
+void wcache_release(void *p_entry)
+{
+	_WCACHE_ENTRY *p_ent = p_entry;
+
+	if(!p_ent) return;
+
+	/* unlinked by _evict before the last reference */
+	if(ref_dec(&p_ent->ref) == 0) _entry_free(p_ent);
+}
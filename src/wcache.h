@@ -0,0 +1,52 @@
+/* -----------------------------------------------------------------------------
+ *  libmpxtn by stkchp
+ * -----------------------------------------------------------------------------
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2017 stkchp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * -------------------------------------------------------------------------- */
+#ifndef MPXTNLIB_WCACHE_H
+#define MPXTNLIB_WCACHE_H
+
+#include "common.h"
+
+#include "woice.h"
+
+/* process-wide cache of decoded woices, keyed by material chunk.
+ * cached instances are read only and shared by songs. */
+
+/* 0: disable and drop unused entries */
+void wcache_set_budget(size_t bytes);
+bool wcache_enabled(void);
+
+/* true if found, p_woice shares the cached woice */
+bool wcache_get(WOICE *p_woice, const void *p_raw, u32 raw_size, WOICETYPE type, const WOICEOPT *p_opt);
+
+/* move decoded p_woice into cache, p_woice shares it after.
+ * p_woice stays as is if it could not be cached. */
+void wcache_put(WOICE *p_woice, const void *p_raw, u32 raw_size, WOICETYPE type, const WOICEOPT *p_opt);
+
+/* called by woice_free */
+void wcache_release(void *p_entry);
+
+#endif
@@ -32,6 +32,8 @@
 #include "ptn.h"
 #include "ptv.h"
 #include "oscillator.h"
+#include "fft.h"
+#include "wcache.h"
 
 /* -------------------------------------------------------------------------- */
 
@@ -59,11 +61,19 @@ void woice_free(WOICE *p_woice)
 {
 	if(!p_woice) return;
 
+	if(p_woice->p_cache) {
+		wcache_release(p_woice->p_cache);
+		memset(p_woice, 0, sizeof(WOICE));
+		return;
+	}
+
 	if(p_woice->insts) {
 		for(u32 i = 0; i < p_woice->size; ++i) {
 			WOICEINSTANCE *p_wi = &p_woice->insts[i];
 			free(p_wi->smps);
-			free(p_wi->envs);
+			free(p_wi->env_pts);
+			for(u32 m = 0; m < p_wi->mip_num; ++m) free(p_wi->mips[m].smps);
+			free(p_wi->mips);
 		}
 	}
 	free(p_woice->insts);
@@ -75,6 +85,25 @@ void woice_free(WOICE *p_woice)
 
 /* -------------------------------------------------------------------------- */
 
+/* stereo which has the same channels is kept as mono */
+static void _shrink_mono(WOICEINSTANCE *p_wi)
+{
+	s16 *p_smps;
+
+	if(p_wi->ch != 2 || !p_wi->smp_num) return;
+
+	for(u32 i = 0; i < p_wi->smp_num; ++i) {
+		if(p_wi->smps[i * 2] != p_wi->smps[i * 2 + 1]) return;
+	}
+
+	for(u32 i = 0; i < p_wi->smp_num; ++i) p_wi->smps[i] = p_wi->smps[i * 2];
+
+	p_smps = realloc(p_wi->smps, p_wi->smp_num * sizeof(s16));
+	if(p_smps) p_wi->smps = p_smps;
+
+	p_wi->ch = 1;
+}
+
 static void _read_voiceflag(WOICEINSTANCE *p_wi, u32 flags)
 {
 	if(flags & VOICEFLAG_WAVELOOP) p_wi->waveloop = true;
@@ -101,13 +130,14 @@ struct _MATERIALSTRUCT_PCM
 	u32 size       ; // 20:4 -> 24byte
 };
 
-bool woice_read_matePCM(WOICE *p_woice, DESCRIPTOR *p_desc)
+bool woice_read_matePCM(WOICE *p_woice, DESCRIPTOR *p_desc, const WOICEOPT *p_opt)
 {
 	struct _MATERIALSTRUCT_PCM m = {0};
 	bool ret = false;
 	void *p_buf = NULL;
 	PCM  pcm = {0};
 	u32  size;
+	u32  sps = p_opt->sps;
 
 	if(!desc_u32_r(p_desc, &size         )) goto End;
 	if(!desc_u16_r(p_desc, &m.dc1        )) goto End;
@@ -140,12 +170,16 @@ bool woice_read_matePCM(WOICE *p_woice, DESCRIPTOR *p_desc)
 		if(!desc_dat_r(p_desc, p_buf, m.size)) goto End;
 
 		/* convert */
-		if(!pcm_mem_read(&pcm, p_buf, m.size, m.ch, m.bps, m.sps)) goto End;
+		if(!pcm_mem_move(&pcm, &p_buf, m.size, m.ch, m.bps, m.sps, sps, p_opt->resample, p_wi->waveloop)) goto End;
 
 		/* move sample data */
 		p_wi->smp_num = pcm.smp_num;
+		p_wi->sps     = sps;
+		p_wi->ch      = (u8)pcm.ch;
 		p_wi->smps = pcm.smps;
 		pcm.smps = NULL;
+
+		_shrink_mono(p_wi);
 	}
 
 	ret = true;
@@ -171,13 +205,13 @@ struct _MATERIALSTRUCT_PTN
 	s32 rrr;         // 12:4 -> 16byte
 };
 
-bool woice_read_matePTN(WOICE *p_woice, DESCRIPTOR *p_desc)
+bool woice_read_matePTN(WOICE *p_woice, DESCRIPTOR *p_desc, const WOICEOPT *p_opt)
 {
-
 	struct _MATERIALSTRUCT_PTN m = {0};
 	bool ret = false;
 	PTN ptn = {0};
 	u32 size;
+	u32 sps = p_opt->sps;
 
 	if(!desc_u32_r(p_desc, &size         )) goto End;
 	if(!desc_u16_r(p_desc, &m.dc1        )) goto End;
@@ -206,9 +240,12 @@ bool woice_read_matePTN(WOICE *p_woice, DESCRIPTOR *p_desc)
 		if(!ptn_read(&ptn, p_desc)) goto End;
 
 		/* sample */
-		p_wi->smp_num = ptn.smp_num;
-		p_wi->smps = ptn_build(&ptn);
+		p_wi->smps = ptn_build(&ptn, sps, p_opt->ptn_threads, &p_wi->smp_num);
 		if(p_wi->smps == NULL) goto End;
+		p_wi->sps = sps;
+		p_wi->ch  = MPXTN_CH;
+
+		_shrink_mono(p_wi);
 	}
 
 	ret = true;
@@ -222,16 +259,110 @@ End:
 
 /* -------------------------------------------------------------------------- */
 
-static bool _sample_ptv(WOICEINSTANCE *p_wi, const PTVINSTANCE *p_pi)
+/* p_wave[smp_num] to p_dst with pan, ch is p_wi->ch */
+static void _quantize_ptv(const WOICEINSTANCE *p_wi, const f64 *p_wave, u32 smp_num, const s32 *pan_volume, s16 *p_dst)
+{
+	f64 work, smp;
+
+	for(u32 s = 0; s < smp_num; ++s) {
+
+		smp = p_wave[s];
+
+		for(u32 c = 0; c < p_wi->ch; ++c)
+		{
+			work = smp * pan_volume[c] / 64;
+			if(work >  1.0) work =  1.0;
+			if(work < -1.0) work = -1.0;
+
+			u32 idx = s * p_wi->ch + c;
+			p_dst[idx] = (s16)(work * INT16_MAX);
+		}
+	}
+}
+
+#define _MIP_SMPNUM_MIN 64 /* shorter levels lose the highs to interpolation */
+
+/* band-limited levels of the cycle p_wave[p_wi->smp_num].
+ * level k keeps harmonics under smp_num / 2^(k + 1), it is half length while it can be. */
+static bool _mip_ptv(WOICEINSTANCE *p_wi, const f64 *p_wave, const s32 *pan_volume)
+{
+	bool ret = false;
+	u32 n = p_wi->smp_num;
+	u32 mip_num = 0;
+	f64 *p_buf = NULL;
+
+	while(mip_num < WOICE_MIP_MAX && (n >> (mip_num + 2)) > 0) mip_num++;
+	if(!mip_num) return true;
+
+	/* spectrum of level 0, then a scratch for each level */
+	p_buf = calloc((size_t)n * 6, sizeof(f64));
+	if(!p_buf) goto End;
+
+	f64 *p_re = p_buf, *p_im = p_buf + n;
+	f64 *p_sre = p_buf + n * 2, *p_sim = p_buf + n * 3;
+	f64 *p_ore = p_buf + n * 4, *p_oim = p_buf + n * 5;
+
+	memcpy(p_re, p_wave, sizeof(f64) * n);
+	if(!fft(p_re, p_im, n, false, p_sre, p_sim)) goto End;
+
+	p_wi->mips = calloc(mip_num, sizeof(WOICEMIP));
+	if(!p_wi->mips) goto End;
+	p_wi->mip_num = mip_num;
+
+	u32 shift = 0;
+
+	for(u32 k = 1; k <= mip_num; ++k) {
+
+		WOICEMIP *p_m = &p_wi->mips[k - 1];
+		u32 harm_num = (n + (2u << k) - 1) / (2u << k); /* h < n / 2^(k + 1) */
+
+		if(!((n >> shift) & 1) && (n >> (shift + 1)) >= _MIP_SMPNUM_MIN) shift++;
+		u32 len = n >> shift;
+
+		/* keep dc and harmonics 1 - (harm_num - 1) in len */
+		memset(p_re, 0, sizeof(f64) * len);
+		memset(p_im, 0, sizeof(f64) * len);
+		p_re[0] = p_sre[0];
+		for(u32 h = 1; h < harm_num; ++h) {
+			p_re[h]       =  p_sre[h];
+			p_im[h]       =  p_sim[h];
+			p_re[len - h] =  p_sre[h];
+			p_im[len - h] = -p_sim[h];
+		}
+		if(!fft(p_re, p_im, len, true, p_ore, p_oim)) goto End;
+		for(u32 s = 0; s < len; ++s) p_ore[s] /= n;
+
+		p_m->smp_num = len;
+		p_m->shift   = (u8)shift;
+		p_m->smps    = calloc((size_t)len * p_wi->ch, sizeof(s16));
+		if(!p_m->smps) goto End;
+
+		_quantize_ptv(p_wi, p_ore, len, pan_volume, p_m->smps);
+	}
+
+	ret = true;
+End:
+	free(p_buf);
+
+	return ret;
+}
+
+static bool _sample_ptv(WOICEINSTANCE *p_wi, const PTVINSTANCE *p_pi, u32 smp_num, bool mip)
 {
-	f64  work, smp;
 	s32  pan_volume[2] = {64, 64};
-	bool overtone;
+	bool ok;
+	f64  *p_wave = NULL;
 	OSCILLATOR osc;
 
-	/* sample */
-	p_wi->smp_num =  400;
-	u32 size = p_wi->smp_num * MPXTN_CH;
+	/* pan */
+	if(p_pi->pan > 64) pan_volume[0] = 128 - p_pi->pan;
+	if(p_pi->pan < 64) pan_volume[1] =       p_pi->pan;
+
+	/* sample (one cycle, pitch is based on 400 samples in MPXTN_SPS) */
+	p_wi->smp_num = smp_num;
+	p_wi->sps     = MPXTN_SPS * (smp_num / WOICE_PTV_SMPNUM);
+	p_wi->ch      = pan_volume[0] == pan_volume[1] ? 1 : MPXTN_CH;
+	u32 size = p_wi->smp_num * p_wi->ch;
 	p_wi->smps = calloc(size, sizeof(s16));
 	if(!p_wi->smps) return false;
 
@@ -241,10 +372,6 @@ static bool _sample_ptv(WOICEINSTANCE *p_wi, const PTVINSTANCE *p_pi)
 
 	_read_voiceflag(p_wi, p_pi->voice_flags);
 
-	/* pan */
-	if(p_pi->pan > 64) pan_volume[0] = 128 - p_pi->pan;
-	if(p_pi->pan < 64) pan_volume[1] =       p_pi->pan;
-
 	/* osci */
 	osc.volume     = p_pi->volume;
 	osc.smp_num    = p_wi->smp_num;
@@ -252,29 +379,20 @@ static bool _sample_ptv(WOICEINSTANCE *p_wi, const PTVINSTANCE *p_pi)
 	osc.point_reso = p_pi->wav.reso;
 	osc.points     = p_pi->wav.points;
 
-	if(p_pi->type == PTV_Overtone) overtone = true;
-	else                           overtone = false;
+	p_wave = malloc(sizeof(f64) * p_wi->smp_num);
+	if(!p_wave) return false;
 
-	for(u32 s = 0; s < p_wi->smp_num; ++s) {
+	if(p_pi->type == PTV_Overtone) ok = oscillator_get_samples_overtone (&osc, p_wave);
+	else                           ok = oscillator_get_samples_coodinate(&osc, p_wave);
 
-		if(overtone) smp = oscillator_get_sample_overtone(&osc, s);
-		else         smp = oscillator_get_sample_coodinate(&osc, s);
+	if(ok) _quantize_ptv(p_wi, p_wave, p_wi->smp_num, pan_volume, p_wi->smps);
+	if(ok && mip) ok = _mip_ptv(p_wi, p_wave, pan_volume);
 
-		for(u32 c = 0; c < MPXTN_CH; ++c)
-		{
-			work = smp * pan_volume[c] / 64;
-			if(work >  1.0) work =  1.0;
-			if(work < -1.0) work = -1.0;
-
-			u32 idx = s * 2 + c;
-			p_wi->smps[idx] = (s16)(work * INT16_MAX);
-		}
-	}
-
-	return true;
+	free(p_wave);
+	return ok;
 }
 
-static bool _envelope_ptv(WOICEINSTANCE *p_wi, const PTVINSTANCE *p_pi)
+static bool _envelope_ptv(WOICEINSTANCE *p_wi, const PTVINSTANCE *p_pi, u32 sps)
 {
 
 	bool ret = false;
@@ -288,12 +406,9 @@ static bool _envelope_ptv(WOICEINSTANCE *p_wi, const PTVINSTANCE *p_pi)
 	{
 		/* calc size */
 		for(e = 0; e < p_env->head_num; ++e) size += p_env->points[e].x;
-		u32 env_size = (u32)((f64)size * MPXTN_SPS / p_env->fps);
+		u32 env_size = (u32)((f64)size * sps / p_env->fps);
 		if(env_size == 0) env_size = 1;
 
-		/* alloc */
-		p_wi->envs = calloc(env_size, 1);
-		if(!p_wi->envs) goto End;
 		p_wi->env_num = env_size;
 
 		points = calloc(p_env->head_num, sizeof(POINT));
@@ -306,41 +421,21 @@ static bool _envelope_ptv(WOICEINSTANCE *p_wi, const PTVINSTANCE *p_pi)
 
 			if( !e || p_env->points[e].x || p_env->points[e].y ) {
 
-				offset += (s32)((f64)p_env->points[e].x * MPXTN_SPS / p_env->fps);
+				offset += (s32)((f64)p_env->points[e].x * sps / p_env->fps);
 				points[e].x = offset;
 				points[e].y = p_env->points[e].y;
 				head_num++;
 			}
 		}
 
-		/* save env */
-		POINT start;
-
-		e = start.x = start.y = 0;
-
-		for(u32 s = 0; s < p_wi->env_num; ++s) {
-
-			while(e < head_num && s >= (u32)points[e].x ) {
-
-				start.x = points[e].x;
-				start.y = points[e].y;
-				e++;
-			}
-
-			if(e < head_num) {
-
-				p_wi->envs[s] = (u8)(start.y + (points[e].y - start.y) *
-							       ((s32)s - start.x) /
-							       (points[e].x - start.x));
-			} else {
-
-				p_wi->envs[s] = (u8)start.y;
-			}
-		}
+		/* evaluated by unit_tone_envelope */
+		p_wi->env_pts    = points;
+		p_wi->env_pt_num = head_num;
+		points = NULL;
 	}
 
 	if(p_env->tail_num) {
-		p_wi->env_release = (s32)((f64)p_env->points[p_env->head_num].x * MPXTN_SPS / p_env->fps);
+		p_wi->env_release = (s32)((f64)p_env->points[p_env->head_num].x * sps / p_env->fps);
 	} else {
 		p_wi->env_release = 0;
 	}
@@ -364,11 +459,12 @@ struct _MATERIALSTRUCT_PTV
 	u32 size; // 8:4 -> 12byte
 };
 
-bool woice_read_matePTV(WOICE *p_woice, DESCRIPTOR *p_desc)
+bool woice_read_matePTV(WOICE *p_woice, DESCRIPTOR *p_desc, const WOICEOPT *p_opt)
 {
 	bool ret = false;
 	PTV ptv = {0};
 	u32 size = 0;
+	u32 sps = p_opt->sps;
 	struct _MATERIALSTRUCT_PTV m = {0};
 
 	if(!desc_u32_r(p_desc, &size  )) goto End;
@@ -390,9 +486,9 @@ bool woice_read_matePTV(WOICE *p_woice, DESCRIPTOR *p_desc)
 
 	for(u32 i = 0; i < p_woice->size; ++i) {
 		/* sample */
-		if(!_sample_ptv  (&p_woice->insts[i], &ptv.insts[i])) goto End;
+		if(!_sample_ptv  (&p_woice->insts[i], &ptv.insts[i], p_opt->ptv_smp_num, p_opt->ptv_mip)) goto End;
 		/* envelope */
-		if(!_envelope_ptv(&p_woice->insts[i], &ptv.insts[i])) goto End;
+		if(!_envelope_ptv(&p_woice->insts[i], &ptv.insts[i], sps)) goto End;
 	}
 
 	ret = true;
@@ -418,8 +514,9 @@ struct _MATERIALSTRUCT_OGG
 	f32 tuning;      // 8:4 -> 12byte
 };
 
-bool woice_read_mateOGGV(WOICE *p_woice, DESCRIPTOR *p_desc)
+bool woice_read_mateOGGV(WOICE *p_woice, DESCRIPTOR *p_desc, const WOICEOPT *p_opt)
 {
+	u32 sps = p_opt->sps;
 	bool ret = false;
 	OGG ogg = {0};
 	PCM pcm = {0};
@@ -449,13 +546,20 @@ bool woice_read_mateOGGV(WOICE *p_woice, DESCRIPTOR *p_desc)
 		/* read data */
 		if(!ogg_read(&ogg, p_desc)) goto End;
 
-		/* convert */
-		if(!pcm_mem_read(&pcm, ogg.p_data, ogg.size, ogg.ch, 16, ogg.sps)) goto End;
+		/* convert, decoded data is moved if possible */
+		void *p_data = ogg.p_data;
+		bool ok = pcm_mem_move(&pcm, &p_data, ogg.size, ogg.ch, 16, ogg.sps, sps, p_opt->resample, p_wi->waveloop);
+		ogg.p_data = p_data;
+		if(!ok) goto End;
 
 		/* move sample data */
 		p_wi->smp_num = pcm.smp_num;
+		p_wi->sps     = sps;
+		p_wi->ch      = (u8)pcm.ch;
 		p_wi->smps = pcm.smps;
 		pcm.smps = NULL;
+
+		_shrink_mono(p_wi);
 	}
 
 	ret = true;
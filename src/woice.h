@@ -40,14 +40,28 @@ typedef enum {
 	WOICE_OGGV,
 } WOICETYPE;
 
+#define WOICE_MIP_MAX 16 /* band-limited levels of a PTV wave */
+
+/* level k keeps harmonics for steps up to 2^k, read at pos >> shift */
+typedef struct {
+	s16 *smps;
+	u32 smp_num;
+	u8  shift;
+} WOICEMIP;
+
 typedef struct {
 	s16 *smps;
 	u32 smp_num;
+	u32 sps;         /* sample rate of smps */
+	u8  ch;          /* channels of smps, 1: mono */
 	s32 basic_key;
 	f64 tuning;
-	u8  *envs;       /* used by PTV */
-	u32 env_num;     /* used by PTV */
+	POINT *env_pts;  /* used by PTV, breakpoints in samples */
+	u32 env_pt_num;  /* used by PTV */
+	u32 env_num;     /* used by PTV, length in samples */
 	s32 env_release; /* used by PTV */
+	WOICEMIP *mips;  /* used by PTV, levels 1 - mip_num */
+	u32 mip_num;
 
 	bool waveloop;
 	bool smooth;
@@ -58,14 +72,27 @@ typedef struct {
 	WOICEINSTANCE *insts;
 	u32           size;
 	WOICETYPE     type;
+	void          *p_cache; /* wcache entry, insts are shared */
 } WOICE;
 
-bool woice_read_matePCM(WOICE *p_woice, DESCRIPTOR *p_desc);
-bool woice_read_matePTN(WOICE *p_woice, DESCRIPTOR *p_desc);
-bool woice_read_matePTV(WOICE *p_woice, DESCRIPTOR *p_desc);
+#define WOICE_PTV_SMPNUM     400 /* one PTV wave cycle, as pxtone */
+#define WOICE_PTV_SCALE_MAX  64  /* ptv_smp_num is WOICE_PTV_SMPNUM x 1 - this */
+
+/* decode parameters */
+typedef struct {
+	u32 sps;         /* output sample rate */
+	u8  resample;    /* RESAMPLE_*, PCM/OGG */
+	u32 ptv_smp_num; /* samples of one PTV wave cycle, multiple of WOICE_PTV_SMPNUM */
+	bool ptv_mip;    /* build WOICEINSTANCE.mips */
+	u32 ptn_threads; /* ptn_build threads, not a cache key as the result is the same */
+} WOICEOPT;
+
+bool woice_read_matePCM(WOICE *p_woice, DESCRIPTOR *p_desc, const WOICEOPT *p_opt);
+bool woice_read_matePTN(WOICE *p_woice, DESCRIPTOR *p_desc, const WOICEOPT *p_opt);
+bool woice_read_matePTV(WOICE *p_woice, DESCRIPTOR *p_desc, const WOICEOPT *p_opt);
 
 #ifdef MPXTN_OGGVORBIS
-bool woice_read_mateOGGV(WOICE *p_woice, DESCRIPTOR *p_desc);
+bool woice_read_mateOGGV(WOICE *p_woice, DESCRIPTOR *p_desc, const WOICEOPT *p_opt);
 #endif
 
 void woice_free(WOICE *p_woice);
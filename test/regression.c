@@ -0,0 +1,339 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <mpxtn.h>
+
+#include "common.h"
+#include "oscillator.h"
+#include "ptn.h"
+
+#include "storm.h"
+
+/* checks of the block and table based paths against the reference player,
+ * built with the library sources to call internal functions. */
+
+static u32 _seed = 1;
+
+static u32 _rand(void)
+{
+	_seed = _seed * 1103515245 + 12345;
+	return _seed >> 8;
+}
+
+static u64 _fnv(const s16 *p, size_t num)
+{
+	u64 h = 1469598103934665603ULL;
+	for(size_t i = 0; i < num; ++i) {
+		h ^= (u16)p[i];
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
+/* -------------------------------------------------------------------------- */
+/* PTV waves, the reference player calculates one sample at a time */
+
+static const f64 _pi = 3.1415926535897932;
+
+static f64 _ref_overtone(const OSCILLATOR *p_osci, s32 idx)
+{
+	f64 work = 0;
+
+	for(s32 i = 0; i < p_osci->point_num; ++i) {
+		const POINT *p = &p_osci->points[i];
+		f64 sss = 2.0 * _pi * p->x * idx / p_osci->smp_num;
+		work += sin(sss) * p->y / p->x / 128.0;
+	}
+
+	return work * p_osci->volume / 128.0;
+}
+
+static f64 _ref_coodinate(const OSCILLATOR *p_osci, s32 idx)
+{
+	s32 x1, y1, x2, y2;
+	s32 c;
+	s32 i = p_osci->point_reso * idx / p_osci->smp_num;
+
+	for(c = 0; c < p_osci->point_num; ++c) {
+		if(p_osci->points[c].x > i) break;
+	}
+
+	if(c == p_osci->point_num) {
+		x1 = p_osci->points[c - 1].x; y1 = p_osci->points[c - 1].y;
+		x2 = p_osci->point_reso;      y2 = p_osci->points[0].y;
+	} else if(c) {
+		x1 = p_osci->points[c - 1].x; y1 = p_osci->points[c - 1].y;
+		x2 = p_osci->points[c    ].x; y2 = p_osci->points[c    ].y;
+	} else {
+		x1 = p_osci->points[0].x;     y1 = p_osci->points[0].y;
+		x2 = p_osci->points[0].x;     y2 = p_osci->points[0].y;
+	}
+
+	i -= x1;
+
+	f64 work = i ? y1 + (f64)(y2 - y1) * i / (x2 - x1) : y1;
+	return work * p_osci->volume / 128.0 / 128.0;
+}
+
+/* same as woice.c, what is played */
+static s16 _quantize(f64 smp, s32 pan_volume)
+{
+	f64 work = smp * pan_volume / 64;
+	if(work >  1.0) work =  1.0;
+	if(work < -1.0) work = -1.0;
+	return (s16)(work * INT16_MAX);
+}
+
+static bool _test_overtone(void)
+{
+	static const s32 scales[] = { 1, 2, 4, 63 };
+	POINT points[16];
+	OSCILLATOR osc;
+	bool ret = true;
+
+	for(u32 t = 0; t < 200 && ret; ++t) {
+
+		osc.smp_num    = 400 * scales[_rand() % 4];
+		osc.volume     = (s32)(_rand() % 129);
+		osc.point_num  = 1 + (s32)(_rand() % 16);
+		osc.point_reso = 0;
+		osc.points     = points;
+
+		for(s32 i = 0; i < osc.point_num; ++i) {
+			points[i].x = 1 + (s32)(_rand() % 64);
+			points[i].y = (s32)(_rand() % 257) - 128;
+		}
+
+		s32 pan_volume = 1 + (s32)(_rand() % 64);
+
+		f64 *p_wave = malloc(sizeof(f64) * (size_t)osc.smp_num);
+		if(!p_wave || !oscillator_get_samples_overtone(&osc, p_wave)) {
+			free(p_wave);
+			return false;
+		}
+
+		/* f64 differs by the phase reduction, played s16 must not */
+		for(s32 idx = 0; idx < osc.smp_num; ++idx) {
+			if(_quantize(p_wave[idx], pan_volume) != _quantize(_ref_overtone(&osc, idx), pan_volume)) {
+				printf("overtone case %u: differs at %d\n", t, idx);
+				ret = false;
+				break;
+			}
+		}
+
+		free(p_wave);
+	}
+
+	return ret;
+}
+
+static bool _test_coodinate(void)
+{
+	static const s32 scales[] = { 1, 2, 4, 63 };
+	POINT points[32];
+	OSCILLATOR osc;
+	bool ret = true;
+
+	for(u32 t = 0; t < 200 && ret; ++t) {
+
+		osc.smp_num    = 400 * scales[_rand() % 4];
+		osc.volume     = (s32)(_rand() % 129);
+		osc.point_num  = 1 + (s32)(_rand() % 32);
+		osc.point_reso = 1 + (s32)(_rand() % 400);
+		osc.points     = points;
+
+		/* x is ascending from 0, may be duplicated or over the resolution */
+		s32 x = 0;
+		for(s32 i = 0; i < osc.point_num; ++i) {
+			points[i].x = x;
+			points[i].y = (s32)(_rand() % 256) - 128;
+			x += (s32)(_rand() % (2 * (u32)osc.point_reso / (u32)osc.point_num + 1));
+		}
+
+		f64 *p_wave = malloc(sizeof(f64) * (size_t)osc.smp_num);
+		if(!p_wave || !oscillator_get_samples_coodinate(&osc, p_wave)) {
+			free(p_wave);
+			return false;
+		}
+
+		for(s32 idx = 0; idx < osc.smp_num; ++idx) {
+			if(p_wave[idx] != _ref_coodinate(&osc, idx)) {
+				printf("coodinate case %u: differs at %d\n", t, idx);
+				ret = false;
+				break;
+			}
+		}
+
+		free(p_wave);
+	}
+
+	return ret;
+}
+
+/* -------------------------------------------------------------------------- */
+/* PTN noise, hashes are of the per sample builder of the reference player */
+
+#define _PTN_CASE_NUM 16
+
+static const u64 _ptn_hashes[_PTN_CASE_NUM] = {
+	0x3d2242e33f699b17ULL, 0xd12d8a0d10c2b20aULL, 0x65764663ea1fa8f4ULL, 0x128e7a6e720128a3ULL,
+	0x4b02e153c06d41adULL, 0xd0f0f87a19594bdcULL, 0xe14e0c7a9ecbfbbaULL, 0x7edc83fc7c4490d7ULL,
+	0x781dc1159db4a7d4ULL, 0x559db2c4b0b62361ULL, 0x407620d82226b462ULL, 0x79eac3037439a9a8ULL,
+	0x6d8949ffd5eefac9ULL, 0xea93fb77b0973d74ULL, 0x79303d1a5cfe03c9ULL, 0xdb42f7fd12511564ULL,
+};
+
+static NOISEDESIGN_OSCILLATOR _ptn_osc(void)
+{
+	NOISEDESIGN_OSCILLATOR o;
+
+	o.type    = (WAVETYPE)(_rand() % WAVETYPE_num);
+	o.freq    = (f32)(_rand() % 20000) / 10;
+	o.volume  = (f32)(_rand() % 1000) / 10;
+	o.offset  = (f32)(_rand() % 1000) / 10;
+	o.reverse = _rand() & 1;
+
+	return o;
+}
+
+static bool _test_ptn(void)
+{
+	static const u32 sps_list[] = { 44100, 48000, 22050, 96000, 8000 };
+	static const s8  pans[]     = { 0, 0, -100, 100, -37, 55 };
+	NOISEDESIGN_UNIT units[NOISEUNIT_MAX];
+	POINT envs[NOISEUNIT_MAX][4];
+	bool ret = true;
+
+	for(u32 t = 0; t < _PTN_CASE_NUM; ++t) {
+
+		PTN ptn = { 0 };
+
+		ptn.size    = (u8)(1 + _rand() % NOISEUNIT_MAX);
+		ptn.smp_num = 100 + _rand() % 20000;
+		ptn.units   = units;
+
+		for(u32 i = 0; i < ptn.size; ++i) {
+			NOISEDESIGN_UNIT *p_u = &units[i];
+			s32 x = 0;
+
+			p_u->enable  = _rand() % 5 != 0;
+			p_u->env_num = _rand() % 5;
+			p_u->envs    = envs[i];
+
+			for(u32 k = 0; k < p_u->env_num; ++k) {
+				x += _rand() % 3 == 0 ? 0 : (s32)(_rand() % 600);
+				envs[i][k].x = x;
+				envs[i][k].y = (s32)(_rand() % 101);
+			}
+
+			p_u->pan  = pans[_rand() % 6];
+			p_u->main = _ptn_osc();
+			p_u->freq = _ptn_osc();
+			p_u->volu = _ptn_osc();
+
+			/* the reference reads out of the table by deep frequency modulation */
+			p_u->freq.volume *= 0.7f;
+		}
+
+		u32 sps = sps_list[_rand() % 5];
+
+		/* serial and parallel */
+		for(u32 threads = 1; threads <= 4; threads += 3) {
+			u32 smp_num = 0;
+			s16 *p_smps = ptn_build(&ptn, sps, threads, &smp_num);
+			u64 h = p_smps ? _fnv(p_smps, smp_num * MPXTN_CH) : 0;
+
+			free(p_smps);
+
+			if(h != _ptn_hashes[t]) {
+				printf("ptn case %u, %u threads: %016llx, expected %016llx\n",
+					t, threads, (unsigned long long)h, (unsigned long long)_ptn_hashes[t]);
+				ret = false;
+			}
+		}
+	}
+
+	return ret;
+}
+
+/* -------------------------------------------------------------------------- */
+/* block rendering of the storm song. hash of none is of the reference player,
+ * which renders one sample at a time. interpolations have no reference, their
+ * hashes are of this player. one sample per call makes blocks of one sample */
+
+static const u64 _storm_hashes[] = {
+	0x69527a7921f31786ULL, 0x3b750c7001128b84ULL, 0x12e9f702ef360952ULL, 0x26487cd75ae2ca3bULL,
+};
+
+static s16 *_render(int interp, size_t chunk, size_t *p_num)
+{
+	MPXTN *mp = mpxtn_mread(_storm_data, _storm_size, NULL);
+	s16 *p_smps = NULL;
+	size_t num = 0;
+	size_t r;
+
+	if(!mp) return NULL;
+
+	mpxtn_set_interpolation(mp, interp);
+
+	*p_num = mpxtn_get_total_samples(mp);
+	p_smps = calloc(*p_num + chunk, sizeof(s16) * MPXTN_CH);
+
+	while(p_smps && (r = mpxtn_vomit(&p_smps[num * MPXTN_CH], chunk, mp)) == chunk) num += r;
+
+	mpxtn_close(mp);
+	return p_smps;
+}
+
+static bool _test_blocks(void)
+{
+	static const size_t chunks[] = { 1, 777, 4096 };
+	bool ret = true;
+
+	for(int interp = MPXTN_INTERP_NONE; interp <= MPXTN_INTERP_SINC; ++interp) {
+		for(u32 c = 0; c < sizeof(chunks) / sizeof(chunks[0]); ++c) {
+
+			size_t num = 0;
+			s16 *p_smps = _render(interp, chunks[c], &num);
+			u64 h = p_smps ? _fnv(p_smps, num * MPXTN_CH) : 0;
+
+			free(p_smps);
+
+			if(h != _storm_hashes[interp]) {
+				printf("blocks interp %d, chunk %zu: %016llx, expected %016llx\n",
+					interp, chunks[c], (unsigned long long)h, (unsigned long long)_storm_hashes[interp]);
+				ret = false;
+			}
+		}
+	}
+
+	return ret;
+}
+
+/* -------------------------------------------------------------------------- */
+
+int main(void) {
+
+	int ret = 0;
+
+	struct {
+		const char *name;
+		bool (*proc)(void);
+	} tests[] = {
+		{ "overtone",  _test_overtone  },
+		{ "coodinate", _test_coodinate },
+		{ "ptn",       _test_ptn       },
+		{ "blocks",    _test_blocks    },
+	};
+
+	for(u32 i = 0; i < sizeof(tests) / sizeof(tests[0]); ++i) {
+		bool ok = tests[i].proc();
+		printf("%-10s %s\n", tests[i].name, ok ? "ok" : "FAILED");
+		if(!ok) ret = 1;
+	}
+
+	return ret;
+}
@@ -0,0 +1,55 @@
+#ifndef MPXTN_TEST_STORM_H
+#define MPXTN_TEST_STORM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* short song with a noise woice */
+const static size_t _storm_size = 683;
+const static uint8_t _storm_data[] = {
+0x50, 0x54, 0x43, 0x4f, 0x4c, 0x4c, 0x41, 0x47, 0x45, 0x2d, 0x30, 0x37, 0x31, 0x31, 0x31, 0x39,
+0x9d, 0x03, 0x00, 0x00, 0x4d, 0x61, 0x73, 0x74, 0x65, 0x72, 0x56, 0x35, 0x0f, 0x00, 0x00, 0x00,
+0xe0, 0x01, 0x04, 0x00, 0x00, 0xf0, 0x42, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x45,
+0x76, 0x65, 0x6e, 0x74, 0x20, 0x56, 0x35, 0xa2, 0x01, 0x00, 0x00, 0x48, 0x00, 0x00, 0x00, 0x00,
+0x01, 0x0c, 0x00, 0x00, 0x02, 0x0c, 0x00, 0x00, 0x00, 0x0c, 0x00, 0x00, 0x01, 0x06, 0xa4, 0x03,
+0x00, 0x02, 0x06, 0xa4, 0x03, 0x00, 0x00, 0x06, 0xe0, 0x03, 0x00, 0x01, 0x02, 0x80, 0x96, 0x01,
+0x00, 0x02, 0x02, 0x80, 0x96, 0x01, 0x00, 0x00, 0x02, 0x80, 0xce, 0x01, 0x00, 0x01, 0x01, 0x80,
+0x3c, 0x00, 0x02, 0x01, 0x80, 0x3c, 0x00, 0x00, 0x01, 0x80, 0x3c, 0x00, 0x01, 0x04, 0x68, 0x00,
+0x02, 0x04, 0x68, 0x00, 0x00, 0x04, 0x68, 0x00, 0x00, 0x05, 0x1c, 0x00, 0x02, 0x0e, 0xcd, 0x99,
+0xb3, 0xfa, 0x03, 0x00, 0x02, 0x0f, 0x28, 0x00, 0x01, 0x0f, 0x58, 0x00, 0x00, 0x0f, 0x48, 0x3c,
+0x01, 0x02, 0x80, 0x9a, 0x01, 0x00, 0x02, 0x02, 0x80, 0x9a, 0x01, 0x78, 0x02, 0x05, 0x58, 0xf0,
+0x01, 0x02, 0x05, 0x50, 0x3c, 0x01, 0x02, 0x80, 0x90, 0x01, 0x00, 0x02, 0x02, 0x80, 0x90, 0x01,
+0x78, 0x00, 0x02, 0x80, 0xbe, 0x01, 0xe8, 0x02, 0x02, 0x05, 0x40, 0x78, 0x01, 0x02, 0x80, 0x94,
+0x01, 0x00, 0x02, 0x02, 0x80, 0x94, 0x01, 0xac, 0x02, 0x02, 0x05, 0x30, 0xf0, 0x01, 0x00, 0x02,
+0x80, 0xc2, 0x01, 0xf0, 0x01, 0x01, 0x02, 0x80, 0x96, 0x01, 0x00, 0x02, 0x02, 0x80, 0x96, 0x01,
+0x3c, 0x01, 0x02, 0x80, 0x9c, 0x01, 0x00, 0x02, 0x02, 0x80, 0x9c, 0x01, 0x3c, 0x02, 0x05, 0x20,
+0xac, 0x02, 0x01, 0x05, 0x60, 0xe8, 0x02, 0x01, 0x02, 0x80, 0xa8, 0x01, 0x00, 0x02, 0x02, 0x80,
+0xa8, 0x01, 0x3c, 0x01, 0x05, 0x58, 0x78, 0x00, 0x02, 0x80, 0xd0, 0x01, 0x00, 0x02, 0x05, 0x30,
+0xa4, 0x03, 0x02, 0x05, 0x50, 0x3c, 0x00, 0x02, 0x80, 0xbc, 0x01, 0x78, 0x01, 0x02, 0x80, 0x9e,
+0x01, 0x00, 0x02, 0x02, 0x80, 0x9e, 0x01, 0xac, 0x02, 0x02, 0x05, 0x58, 0x00, 0x01, 0x05, 0x50,
+0xf0, 0x01, 0x02, 0x05, 0x60, 0xf0, 0x01, 0x01, 0x05, 0x48, 0xac, 0x02, 0x00, 0x02, 0x80, 0xca,
+0x01, 0x3c, 0x01, 0x02, 0x80, 0x96, 0x01, 0x00, 0x02, 0x02, 0x80, 0x96, 0x01, 0x3c, 0x01, 0x02,
+0x80, 0x96, 0x01, 0x00, 0x02, 0x02, 0x80, 0x96, 0x01, 0x00, 0x01, 0x05, 0x40, 0xa4, 0x03, 0x01,
+0x05, 0x38, 0xf0, 0x01, 0x01, 0x05, 0x30, 0x78, 0x00, 0x02, 0x80, 0xd2, 0x01, 0xa4, 0x03, 0x01,
+0x02, 0x80, 0x92, 0x01, 0x00, 0x02, 0x02, 0x80, 0x92, 0x01, 0x3c, 0x00, 0x02, 0x80, 0xde, 0x01,
+0xd8, 0x04, 0x01, 0x05, 0x38, 0xf0, 0x01, 0x00, 0x02, 0x80, 0xce, 0x01, 0xf0, 0x01, 0x01, 0x05,
+0x40, 0x3c, 0x01, 0x02, 0x80, 0x96, 0x01, 0x00, 0x02, 0x02, 0x80, 0x96, 0x01, 0xf0, 0x01, 0x01,
+0x05, 0x48, 0x78, 0x01, 0x05, 0x50, 0x3c, 0x01, 0x05, 0x58, 0x78, 0x01, 0x05, 0x60, 0x6d, 0x61,
+0x74, 0x65, 0x50, 0x54, 0x4e, 0x20, 0x45, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x45, 0x03, 0x00,
+0x00, 0x00, 0x00, 0x00, 0x80, 0x3f, 0x01, 0x00, 0x00, 0x00, 0x50, 0x54, 0x4e, 0x4f, 0x49, 0x53,
+0x45, 0x2d, 0x62, 0x03, 0x33, 0x01, 0x86, 0xdf, 0x01, 0x02, 0x14, 0x03, 0x00, 0x64, 0xe8, 0x07,
+0x64, 0x00, 0x00, 0x04, 0x00, 0xc0, 0xb8, 0x02, 0x9c, 0x04, 0x00, 0x34, 0x03, 0x00, 0x64, 0xe8,
+0x07, 0x64, 0x00, 0x00, 0x04, 0x00, 0x90, 0x4e, 0x50, 0x00, 0x04, 0x00, 0x1e, 0x64, 0x00, 0x61,
+0x73, 0x73, 0x69, 0x57, 0x4f, 0x49, 0x43, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x73,
+0x74, 0x72, 0x65, 0x61, 0x6d, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x6e,
+0x75, 0x6d, 0x20, 0x55, 0x4e, 0x49, 0x54, 0x04, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x61,
+0x73, 0x73, 0x69, 0x55, 0x4e, 0x49, 0x54, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x75,
+0x2d, 0x73, 0x74, 0x72, 0x65, 0x61, 0x6d, 0x00, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0x61,
+0x73, 0x73, 0x69, 0x55, 0x4e, 0x49, 0x54, 0x14, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x75,
+0x2d, 0x73, 0x74, 0x72, 0x65, 0x61, 0x6d, 0x00, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0x61,
+0x73, 0x73, 0x69, 0x55, 0x4e, 0x49, 0x54, 0x14, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x75,
+0x2d, 0x73, 0x74, 0x72, 0x65, 0x61, 0x6d, 0x00, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0x70,
+0x78, 0x74, 0x6f, 0x6e, 0x65, 0x4e, 0x44, 0x00, 0x00, 0x00, 0x00,
+};
+
+#endif